@@ -29,16 +29,204 @@
 #pragma once
 
 #include <armadillo>
+#include <algorithm>
+#include <cmath>
 #include <utility>
+#include <vector>
 
 #include "element.hpp"
 
-template<typename T>
+/* Families of 1D polynomials on the scaled coordinate ep = (x - bar)/h, which
+ * lives in [-1/2, 1/2] on every element. They are used as policies for the
+ * basis class below. Each family fills a (points x functions) column-major
+ * array with the values of its polynomials and with their derivatives with
+ * respect to ep. The code in the operators assumes that the first function is
+ * the constant 1 and that the families are hierarchical.
+ * Each family also gives in closed form the integrals over [-1/2, 1/2] of the
+ * products of two of its functions (mass) and of their derivatives with
+ * respect to ep (stiffness), see moment_table.hpp.
+ */
+struct scaled_monomials
+{
+    /* The mass matrix is not diagonal */
+    static const bool orthogonal = false;
+    
+    /* Integral of ep^p over [-1/2, 1/2] */
+    template<typename T>
+    static T
+    moment(size_t p)
+    {
+        if (p % 2)
+            return 0;
+        
+        return T(1) / ( std::pow(T(2), T(p)) * T(p+1) );
+    }
+    
+    template<typename T>
+    static T
+    mass(size_t i, size_t j)
+    {
+        return moment<T>(i+j);
+    }
+    
+    /* d/dep ep^i = i ep^(i-1) */
+    template<typename T>
+    static T
+    stiffness(size_t i, size_t j)
+    {
+        if (i == 0 or j == 0)
+            return 0;
+        
+        return T(i*j) * moment<T>(i+j-2);
+    }
+    
+    template<typename T>
+    static void
+    functions(const T *ep, size_t num_points, size_t degree, T *phi)
+    {
+        for (size_t j = 0; j < num_points; j++)
+            phi[j] = 1.;
+        
+        for (size_t i = 1; i < degree+1; i++)
+        {
+            const T *prev = phi + (i-1)*num_points;
+            T *cur = phi + i*num_points;
+            for (size_t j = 0; j < num_points; j++)
+                cur[j] = prev[j] * ep[j];
+        }
+    }
+    
+    template<typename T>
+    static void
+    derivatives(const T *ep, size_t num_points, size_t degree, T *dphi)
+    {
+        for (size_t j = 0; j < num_points; j++)
+            dphi[j] = 0.;
+        
+        if (degree == 0)
+            return;
+        
+        T *dphi1 = dphi + num_points;
+        for (size_t j = 0; j < num_points; j++)
+            dphi1[j] = 1.;
+        
+        /* d/dep ep^i = i ep^(i-1) = (i/(i-1)) * ep * d/dep ep^(i-1) */
+        for (size_t i = 2; i < degree+1; i++)
+        {
+            const T *prev = dphi + (i-1)*num_points;
+            T *cur = dphi + i*num_points;
+            T coeff = T(i)/T(i-1);
+            for (size_t j = 0; j < num_points; j++)
+                cur[j] = coeff * prev[j] * ep[j];
+        }
+    }
+};
+
+/* Legendre polynomials P_i(2 ep). They are orthogonal on the element, so the
+ * mass matrix is diagonal with entries h/(2i+1). They are normalized with
+ * P_i(1) = 1 instead of being orthonormal, so that the first function is still
+ * the constant 1 and the values do not depend on h.
+ */
+struct scaled_legendre
+{
+    /* The mass matrix is diagonal */
+    static const bool orthogonal = true;
+    
+    /* With x = 2 ep, the integral of P_i P_i over [-1, 1] is 2/(2i+1) */
+    template<typename T>
+    static T
+    mass(size_t i, size_t j)
+    {
+        return (i == j) ? T(1)/T(2*i+1) : T(0);
+    }
+    
+    /* The integral of P'_i P'_j over [-1, 1] is m(m+1), m = min(i, j), if
+     * i+j is even and 0 otherwise, and d/dep = 2 d/dx */
+    template<typename T>
+    static T
+    stiffness(size_t i, size_t j)
+    {
+        if (i == 0 or j == 0 or (i+j) % 2)
+            return 0;
+        
+        size_t m = std::min(i, j);
+        return T(2*m*(m+1));
+    }
+    
+    template<typename T>
+    static void
+    functions(const T *ep, size_t num_points, size_t degree, T *phi)
+    {
+        for (size_t j = 0; j < num_points; j++)
+            phi[j] = 1.;
+        
+        if (degree == 0)
+            return;
+        
+        T *phi1 = phi + num_points;
+        for (size_t j = 0; j < num_points; j++)
+            phi1[j] = 2*ep[j];
+        
+        /* Bonnet: i P_i(x) = (2i-1) x P_(i-1)(x) - (i-1) P_(i-2)(x) */
+        for (size_t i = 2; i < degree+1; i++)
+        {
+            const T *prev2 = phi + (i-2)*num_points;
+            const T *prev1 = phi + (i-1)*num_points;
+            T *cur = phi + i*num_points;
+            T a = T(2*i-1)/T(i);
+            T b = T(i-1)/T(i);
+            for (size_t j = 0; j < num_points; j++)
+                cur[j] = a * 2*ep[j] * prev1[j] - b * prev2[j];
+        }
+    }
+    
+    template<typename T>
+    static void
+    derivatives(const T *ep, size_t num_points, size_t degree, T *dphi)
+    {
+        for (size_t j = 0; j < num_points; j++)
+            dphi[j] = 0.;
+        
+        if (degree == 0)
+            return;
+        
+        T *dphi1 = dphi + num_points;
+        for (size_t j = 0; j < num_points; j++)
+            dphi1[j] = 2.;
+        
+        /* P'_i(x) = i P_(i-1)(x) + x P'_(i-1)(x), keeping P_(i-1) on the
+         * fly, and d/dep = 2 d/dx.
+         */
+        std::vector<T> p_prev2(num_points, 1.), p_prev1(num_points);
+        for (size_t j = 0; j < num_points; j++)
+            p_prev1[j] = 2*ep[j];
+        
+        for (size_t i = 2; i < degree+1; i++)
+        {
+            const T *prev = dphi + (i-1)*num_points;
+            T *cur = dphi + i*num_points;
+            T a = T(2*i-1)/T(i);
+            T b = T(i-1)/T(i);
+            for (size_t j = 0; j < num_points; j++)
+            {
+                auto x = 2*ep[j];
+                cur[j] = 2*i*p_prev1[j] + x*prev[j];
+                auto p = a * x * p_prev1[j] - b * p_prev2[j];
+                p_prev2[j] = p_prev1[j];
+                p_prev1[j] = p;
+            }
+        }
+    }
+};
+
+template<typename T, typename Family = scaled_monomials>
 class basis
 {
     size_t  m_degree;
     
 public:
+    typedef Family  family_type;
+    
     basis()
         : m_degree(1)
     {}
@@ -48,34 +236,58 @@ public:
     {}
     
     arma::Col<T>
-    eval_functions(const element<T>& elem, const T& point)
+    eval_functions(const element<T>& elem, const T& point) const
     {
         auto bar = elem.center();
         auto h = elem.measure();
         auto ep = (point - bar)/h;
         
         arma::Col<T> ret(m_degree+1);
-        for(size_t i = 0; i < m_degree+1; i++)
-            ret(i) = std::pow(ep, i);
+        Family::functions(&ep, 1, m_degree, ret.memptr());
         
         return ret;
     }
     
     arma::Col<T>
-    eval_gradients(const element<T>& elem, const T& point)
+    eval_gradients(const element<T>& elem, const T& point) const
     {
         auto bar = elem.center();
         auto h = elem.measure();
         auto ep = (point - bar)/h;
         
         arma::Col<T> ret(m_degree+1);
-        ret(0) = 0.;
-        for(size_t i = 1; i < m_degree+1; i++)
-            ret(i) = (i/h)*std::pow(ep, i-1);
+        Family::derivatives(&ep, 1, m_degree, ret.memptr());
+        
+        return ret/h;
+    }
+    
+    /* Batched versions: evaluate all the basis functions on all the points at
+     * once. The result is a (points x functions) matrix, so each function is
+     * stored contiguously and the recurrences of the families run over
+     * contiguous memory, which the compiler can vectorize.
+     */
+    arma::Mat<T>
+    eval_functions(const element<T>& elem, const std::vector<T>& points) const
+    {
+        auto ep = scaled_points(elem, points);
+        
+        arma::Mat<T> ret(points.size(), m_degree+1);
+        Family::functions(ep.data(), ep.size(), m_degree, ret.memptr());
         
         return ret;
     }
     
+    arma::Mat<T>
+    eval_gradients(const element<T>& elem, const std::vector<T>& points) const
+    {
+        auto ep = scaled_points(elem, points);
+        
+        arma::Mat<T> ret(points.size(), m_degree+1);
+        Family::derivatives(ep.data(), ep.size(), m_degree, ret.memptr());
+        
+        return ret/elem.measure();
+    }
+    
     size_t size() const
     {
         return m_degree+1;
@@ -85,5 +297,18 @@ public:
     {
         return degree;
     }
+    
+private:
+    std::vector<T>
+    scaled_points(const element<T>& elem, const std::vector<T>& points) const
+    {
+        auto bar = elem.center();
+        auto inv_h = T(1)/elem.measure();
+        
+        std::vector<T> ret(points.size());
+        for (size_t j = 0; j < points.size(); j++)
+            ret[j] = (points[j] - bar)*inv_h;
+        
+        return ret;
+    }
 };
-
@@ -0,0 +1,109 @@
+/*
+ *       /\
+ *      /__\        Matteo Cicuttin (C) 2016 - matteo.cicuttin@enpc.fr
+ *     /_\/_\
+ *    /\    /\      École Nationale des Ponts et Chaussées
+ *   /__\  /__\     CERMICS
+ *  /_\/_\/_\/_\
+ *
+ * This is a simple 1D code for the demonstration of the Hybrid High Order
+ * numerical method. It is intended only to show the details of all the
+ * involved operators (projection, gradient reconstruction, stabilization)
+ * step by step.
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <vector>
+#include <armadillo>
+
+#include "element.hpp"
+#include "quadrature.hpp"
+#include "basis.hpp"
+
+/* The basis is scaled with (x - bar)/h, so its values at the quadrature nodes
+ * and at the faces are the same on every element and the gradients differ only
+ * by the 1/h factor. This class evaluates the basis once on a reference element
+ * of unit measure; the operators then read the values from here instead of
+ * evaluating the basis element by element. The gradients are stored without
+ * the 1/h factor, which has to be applied by the caller.
+ * The values at the quadrature nodes are kept as a (points x basis) matrix B,
+ * so that a load over all the nodes is the single product B^T (w f) and the
+ * values of a function at all the nodes are B u.
+ */
+template<typename T, typename Family = scaled_monomials>
+class basis_table
+{
+    std::vector<arma::Col<T>>   m_phi_faces, m_dphi_faces;
+    arma::Mat<T>                m_phi_matrix;
+    
+public:
+    basis_table()
+    {}
+    
+    /* Only the values at the faces: enough for the operators which take the
+     * cell integrals from a moment_table. num_points() is then 0. */
+    explicit basis_table(const basis<T, Family>& basis)
+    {
+        element<T> ref_elem(-0.5, 0.5);
+        
+        for (auto fc : ref_elem.faces())
+        {
+            m_phi_faces.push_back( basis.eval_functions(ref_elem, fc) );
+            m_dphi_faces.push_back( basis.eval_gradients(ref_elem, fc) );
+        }
+    }
+    
+    basis_table(const basis<T, Family>& basis, const quadrature<T>& quad)
+        : basis_table(basis)
+    {
+        element<T> ref_elem(-0.5, 0.5);
+        
+        auto mq = quad.map(ref_elem);
+        m_phi_matrix.set_size(mq.size(), basis.size());
+        
+        size_t iqp = 0;
+        for (auto qp : mq)
+            m_phi_matrix.row(iqp++) = basis.eval_functions(ref_elem, qp.first).t();
+    }
+    
+    /* Basis functions on the face i (0 = left, 1 = right) */
+    const arma::Col<T>&
+    face_functions(size_t i) const
+    {
+        return m_phi_faces[i];
+    }
+    
+    /* Basis gradients on the face i (0 = left, 1 = right), times h */
+    const arma::Col<T>&
+    face_gradients(size_t i) const
+    {
+        return m_dphi_faces[i];
+    }
+    
+    /* Basis functions at all the quadrature points, one point per row */
+    const arma::Mat<T>&
+    function_matrix(void) const
+    {
+        return m_phi_matrix;
+    }
+    
+    size_t num_points() const
+    {
+        return m_phi_matrix.n_rows;
+    }
+};
@@ -0,0 +1,436 @@
+/*
+ *       /\
+ *      /__\        Matteo Cicuttin (C) 2016 - matteo.cicuttin@enpc.fr
+ *     /_\/_\
+ *    /\    /\      École Nationale des Ponts et Chaussées
+ *   /__\  /__\     CERMICS
+ *  /_\/_\/_\/_\
+ *
+ * This is a simple 1D code for the demonstration of the Hybrid High Order
+ * numerical method. It is intended only to show the details of all the
+ * involved operators (projection, gradient reconstruction, stabilization)
+ * step by step.
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <cassert>
+#include <vector>
+#include <armadillo>
+
+#include "element.hpp"
+#include "quadrature.hpp"
+#include "basis.hpp"
+#include "basis_table.hpp"
+#include "moment_table.hpp"
+#include "static_condensation.hpp"
+#include "profiler.hpp"
+
+/* Number of elements of type T in a SIMD register of the target instruction
+ * set: a batch of this many elements fills exactly one register per entry of
+ * the local matrices. */
+template<typename T>
+struct simd_batch_width
+{
+#if defined(__AVX512F__)
+    static const size_t value = 64/sizeof(T);
+#elif defined(__AVX__)
+    static const size_t value = 32/sizeof(T);
+#else
+    static const size_t value = 16/sizeof(T);
+#endif
+};
+
+/* Static condensation of W elements at a time, with compile-time degree K.
+ * It computes the same AC, bC and condensation records as
+ * condense_elements_fixed(), but the local matrices of the elements of a
+ * batch are interleaved: entry (i,j) of all the W matrices is stored in the
+ * contiguous array m(i,j)[0..W-1], one lane per element. Every step (load
+ * projection, gradient reconstruction, stabilization, Cholesky, condensation)
+ * is then a sequence of loops over the lanes with no dependency between them,
+ * which the compiler maps to full-width SIMD instructions.
+ *
+ * The local operators are small (K+3 unknowns), so one element alone cannot
+ * fill the vector units; W elements side by side can.
+ */
+template<typename T, size_t K, typename Family = scaled_monomials,
+         size_t W = simd_batch_width<T>::value>
+class batched_condensation
+{
+public:
+    static const size_t width       = W;
+    static const size_t cell_size   = K+1;  /* cell unknowns */
+    static const size_t dofs_size   = K+3;  /* cell and face unknowns */
+    static const size_t rec_size    = K+1;  /* reconstruction, without the constant */
+    
+private:
+    static const size_t cs = cell_size;
+    static const size_t ds = dofs_size;
+    static const size_t rs = rec_size;
+    
+    typedef T lanes[W];
+    
+    /* Data of the reference element, the same for all the elements */
+    T                       m_MG_ref[rs][rs];   /* stiffness of the reconstruction */
+    T                       m_BG_ref[rs][ds];   /* rhs of the reconstruction */
+    T                       m_M1_ref[cs][cs];   /* cell mass */
+    T                       m_M2_ref[cs][rs];   /* cell - reconstruction mass */
+    T                       m_phiF[2][rs+1];    /* reconstruction basis on the faces */
+    arma::Mat<T>            m_load_table;       /* cell basis at the nodes */
+    std::vector<T>          m_nodes, m_weights; /* nodes and weights on [0, 1] */
+    
+    /* Interleaved data of the current batch */
+    lanes                   m_h, m_ih;
+    lanes                   m_fw[K+1];          /* weighted load at the nodes */
+    lanes                   m_MG[rs][rs];
+    lanes                   m_BG[rs][ds];
+    lanes                   m_R[rs][ds];
+    lanes                   m_M1[cs][cs];
+    lanes                   m_P[cs][ds];        /* proj1 = I_T - M1^-1 M2 R */
+    lanes                   m_B[ds];            /* face difference operator */
+    lanes                   m_LC[ds][ds];       /* A + S */
+    lanes                   m_KTT[cs][cs];
+    lanes                   m_X[cs][3];         /* [K_TF, f_T], then [AL, bL] */
+    lanes                   m_C[2][3];          /* [AC, bC] */
+    
+    /* Cholesky factorization A = L L^T in each lane, L overwrites the lower
+     * triangle of A */
+    template<size_t N>
+    static void
+    cholesky_factor(lanes (&A)[N][N])
+    {
+        for (size_t j = 0; j < N; j++)
+        {
+            for (size_t k = 0; k < j; k++)
+                for (size_t l = 0; l < W; l++)
+                    A[j][j][l] -= A[j][k][l] * A[j][k][l];
+            
+            for (size_t l = 0; l < W; l++)
+                A[j][j][l] = std::sqrt(A[j][j][l]);
+            
+            for (size_t i = j+1; i < N; i++)
+            {
+                for (size_t k = 0; k < j; k++)
+                    for (size_t l = 0; l < W; l++)
+                        A[i][j][l] -= A[i][k][l] * A[j][k][l];
+                
+                for (size_t l = 0; l < W; l++)
+                    A[i][j][l] /= A[j][j][l];
+            }
+        }
+    }
+    
+    /* Solve L L^T X = B in each lane, in place for the M columns of B */
+    template<size_t N, size_t M>
+    static void
+    cholesky_solve(const lanes (&L)[N][N], lanes (&B)[N][M])
+    {
+        for (size_t c = 0; c < M; c++)
+        {
+            for (size_t i = 0; i < N; i++)
+            {
+                for (size_t k = 0; k < i; k++)
+                    for (size_t l = 0; l < W; l++)
+                        B[i][c][l] -= L[i][k][l] * B[k][c][l];
+                
+                for (size_t l = 0; l < W; l++)
+                    B[i][c][l] /= L[i][i][l];
+            }
+            
+            for (size_t i = N; i-- > 0; )
+            {
+                for (size_t k = i+1; k < N; k++)
+                    for (size_t l = 0; l < W; l++)
+                        B[i][c][l] -= L[k][i][l] * B[k][c][l];
+                
+                for (size_t l = 0; l < W; l++)
+                    B[i][c][l] /= L[i][i][l];
+            }
+        }
+    }
+    
+    /* Gradient reconstruction R and A = BG^T R: MG and BG are the reference
+     * ones scaled by 1/h */
+    void
+    build_reconstruction(void)
+    {
+        for (size_t i = 0; i < rs; i++)
+            for (size_t j = 0; j < rs; j++)
+                for (size_t l = 0; l < W; l++)
+                    m_MG[i][j][l] = m_MG_ref[i][j] * m_ih[l];
+        
+        for (size_t i = 0; i < rs; i++)
+        {
+            for (size_t j = 0; j < ds; j++)
+            {
+                for (size_t l = 0; l < W; l++)
+                {
+                    m_BG[i][j][l] = m_BG_ref[i][j] * m_ih[l];
+                    m_R[i][j][l] = m_BG[i][j][l];
+                }
+            }
+        }
+        
+        cholesky_factor(m_MG);
+        cholesky_solve(m_MG, m_R);
+        
+        for (size_t i = 0; i < ds; i++)
+        {
+            for (size_t j = 0; j < ds; j++)
+            {
+                for (size_t l = 0; l < W; l++)
+                    m_LC[i][j][l] = 0;
+                
+                for (size_t k = 0; k < rs; k++)
+                    for (size_t l = 0; l < W; l++)
+                        m_LC[i][j][l] += m_BG[k][i][l] * m_R[k][j][l];
+            }
+        }
+    }
+    
+    /* Stabilization, added to A in m_LC */
+    void
+    build_stabilization(void)
+    {
+        /* proj1 = I_T - M1^-1 M2 R */
+        for (size_t i = 0; i < cs; i++)
+        {
+            for (size_t j = 0; j < ds; j++)
+            {
+                for (size_t l = 0; l < W; l++)
+                    m_P[i][j][l] = 0;
+                
+                for (size_t k = 0; k < rs; k++)
+                    for (size_t l = 0; l < W; l++)
+                        m_P[i][j][l] -= (m_M2_ref[i][k] * m_h[l]) * m_R[k][j][l];
+            }
+        }
+        
+        for (size_t i = 0; i < cs; i++)
+            for (size_t j = 0; j < cs; j++)
+                for (size_t l = 0; l < W; l++)
+                    m_M1[i][j][l] = m_M1_ref[i][j] * m_h[l];
+        
+        if (Family::orthogonal)
+        {
+            /* M1 is diagonal, the solve is just a scaling of the rows */
+            for (size_t i = 0; i < cs; i++)
+                for (size_t j = 0; j < ds; j++)
+                    for (size_t l = 0; l < W; l++)
+                        m_P[i][j][l] /= m_M1[i][i][l];
+        }
+        else
+        {
+            cholesky_factor(m_M1);
+            cholesky_solve(m_M1, m_P);
+        }
+        
+        for (size_t i = 0; i < cs; i++)
+            for (size_t l = 0; l < W; l++)
+                m_P[i][i][l] += 1;
+        
+        /* The face mass matrix is the scalar 1, as phiF(0) is always 1 */
+        for (size_t face = 0; face < 2; face++)
+        {
+            auto& phiF = m_phiF[face];
+            
+            for (size_t j = 0; j < ds; j++)
+            {
+                for (size_t l = 0; l < W; l++)
+                    m_B[j][l] = 0;
+                
+                for (size_t k = 0; k < rs; k++)
+                    for (size_t l = 0; l < W; l++)
+                        m_B[j][l] += phiF[k+1] * m_R[k][j][l];
+                
+                for (size_t k = 0; k < cs; k++)
+                    for (size_t l = 0; l < W; l++)
+                        m_B[j][l] += phiF[k] * m_P[k][j][l];
+            }
+            
+            for (size_t l = 0; l < W; l++)
+                m_B[cs+face][l] -= 1;
+            
+            for (size_t i = 0; i < ds; i++)
+                for (size_t j = 0; j < ds; j++)
+                    for (size_t l = 0; l < W; l++)
+                        m_LC[i][j][l] += m_B[i][l] * m_B[j][l] * m_ih[l];
+        }
+    }
+    
+public:
+    batched_condensation()
+    {
+        basis<T, Family>        rec_basis(K+1), cell_basis(K);
+        quadrature<T>           quad(2*K);
+        basis_table<T, Family>  rec_table(rec_basis);
+        basis_table<T, Family>  cell_table(cell_basis, quad);
+        moment_table<T, Family> moments(rec_basis.size());
+        
+        auto& K_ref = moments.reference_stiffness();
+        auto& M_ref = moments.reference_mass();
+        
+        for (size_t face = 0; face < 2; face++)
+            for (size_t i = 0; i < rs+1; i++)
+                m_phiF[face][i] = rec_table.face_functions(face)(i);
+        
+        /* Face gradients in the table are not scaled by 1/h. Beware of the
+         * signs: they are due to the normals */
+        auto& dphiF1 = rec_table.face_gradients(0);
+        auto& dphiF2 = rec_table.face_gradients(1);
+        for (size_t i = 0; i < rs; i++)
+        {
+            for (size_t j = 0; j < rs; j++)
+                m_MG_ref[i][j] = K_ref(i+1,j+1);
+            
+            for (size_t j = 0; j < cs; j++)
+                m_BG_ref[i][j] = K_ref(i+1,j) + dphiF1(i+1) * m_phiF[0][j]
+                                              - dphiF2(i+1) * m_phiF[1][j];
+            
+            m_BG_ref[i][cs]     = - dphiF1(i+1);
+            m_BG_ref[i][cs+1]   = + dphiF2(i+1);
+        }
+        
+        for (size_t i = 0; i < cs; i++)
+        {
+            for (size_t j = 0; j < cs; j++)
+                m_M1_ref[i][j] = M_ref(i,j);
+            
+            for (size_t j = 0; j < rs; j++)
+                m_M2_ref[i][j] = M_ref(i,j+1);
+        }
+        
+        /* The same nodes and weights as the projector, mapped on [0, 1] so
+         * that x = x0 + node*h and w = weight*h on each element */
+        m_load_table = cell_table.function_matrix();
+        for (auto qp : quad.map(element<T>(0, 1)))
+        {
+            m_nodes.push_back(qp.first);
+            m_weights.push_back(qp.second);
+        }
+        assert(m_nodes.size() <= K+1);
+    }
+    
+    /* Condense the W elements elems[0..W-1]. Their AC and bC go to the
+     * columns of condensed, laid out as in solve_diffusion_problem, and if
+     * store is not null their records are kept there. The elements are
+     * numbered from first in both. */
+    template<typename Function>
+    void
+    condense(const Function& pf, const element<T> *elems, size_t first,
+             arma::Mat<T>& condensed, condensation_store<T> *store)
+    {
+        for (size_t l = 0; l < W; l++)
+        {
+            m_h[l] = elems[l].measure();
+            m_ih[l] = T(1) / m_h[l];
+        }
+        
+        /* Load at the nodes: the evaluation of pf is the only step which is
+         * not vectorized, unless pf is simple enough to be inlined */
+        size_t num_nodes = m_nodes.size();
+        for (size_t q = 0; q < num_nodes; q++)
+        {
+            for (size_t l = 0; l < W; l++)
+            {
+                T x = m_nodes[q] * m_h[l] + elems[l].points()[0];
+                m_fw[q][l] = (m_weights[q] * m_h[l]) * pf(x);
+            }
+        }
+        
+        /* f_T = B^T (w f), in the last column of X */
+        for (size_t i = 0; i < cs; i++)
+        {
+            for (size_t l = 0; l < W; l++)
+                m_X[i][2][l] = 0;
+            
+            for (size_t q = 0; q < num_nodes; q++)
+            {
+                T b = m_load_table(q,i);
+                for (size_t l = 0; l < W; l++)
+                    m_X[i][2][l] += b * m_fw[q][l];
+            }
+        }
+        
+        {
+            PROFILE_SCOPE_DETAIL("diffusion/solve/condensation/local operators");
+            build_reconstruction();
+            build_stabilization();
+        }
+        
+        /* Static condensation: AL = K_TT^-1 K_TF, bL = K_TT^-1 f_T */
+        for (size_t i = 0; i < cs; i++)
+        {
+            for (size_t l = 0; l < W; l++)
+            {
+                m_X[i][0][l] = m_LC[i][cs][l];
+                m_X[i][1][l] = m_LC[i][cs+1][l];
+            }
+            
+            for (size_t j = 0; j < cs; j++)
+                for (size_t l = 0; l < W; l++)
+                    m_KTT[i][j][l] = m_LC[i][j][l];
+        }
+        
+        cholesky_factor(m_KTT);
+        cholesky_solve(m_KTT, m_X);
+        
+        /* AC = K_FF - K_FT AL and bC = - K_FT bL */
+        for (size_t i = 0; i < 2; i++)
+        {
+            for (size_t j = 0; j < 3; j++)
+            {
+                for (size_t l = 0; l < W; l++)
+                    m_C[i][j][l] = (j < 2) ? m_LC[cs+i][cs+j][l] : T(0);
+                
+                for (size_t k = 0; k < cs; k++)
+                    for (size_t l = 0; l < W; l++)
+                        m_C[i][j][l] -= m_LC[cs+i][k][l] * m_X[k][j][l];
+            }
+        }
+        
+        /* Back to one column per element */
+        for (size_t l = 0; l < W; l++)
+        {
+            T *cd = condensed.colptr(first+l);
+            for (size_t j = 0; j < 3; j++)
+                for (size_t i = 0; i < 2; i++)
+                    cd[2*j+i] = m_C[i][j][l];
+        }
+        
+        if (!store)
+            return;
+        
+        for (size_t l = 0; l < W; l++)
+        {
+            T AL[2*cs], bL[cs], R[rs*ds];
+            for (size_t i = 0; i < cs; i++)
+            {
+                AL[i]       = m_X[i][0][l];
+                AL[cs+i]    = m_X[i][1][l];
+                bL[i]       = m_X[i][2][l];
+            }
+            
+            for (size_t j = 0; j < ds; j++)
+                for (size_t i = 0; i < rs; i++)
+                    R[j*rs+i] = m_R[i][j][l];
+            
+            store->store(first+l, AL, bL, R);
+        }
+    }
+};
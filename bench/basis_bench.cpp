@@ -0,0 +1,126 @@
+/*
+ *       /\
+ *      /__\        Matteo Cicuttin (C) 2016 - matteo.cicuttin@enpc.fr
+ *     /_\/_\
+ *    /\    /\      École Nationale des Ponts et Chaussées
+ *   /__\  /__\     CERMICS
+ *  /_\/_\/_\/_\
+ *
+ * This is a simple 1D code for the demonstration of the Hybrid High Order
+ * numerical method. It is intended only to show the details of all the
+ * involved operators (projection, gradient reconstruction, stabilization)
+ * step by step.
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Comparison of the two bases at high degree: for each degree it times the
+ * construction of the local operator (hho_local_operator) and the local
+ * solve of the static condensation with K_TT, and reports the condition
+ * numbers of the cell mass matrix and of K_TT together with the relative
+ * error of the local solve for a known solution.
+ *
+ *   basis-bench [max_degree] [num_elements]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <string>
+
+#include "element.hpp"
+#include "basis.hpp"
+#include "moment_table.hpp"
+#include "hho_local_operator.hpp"
+#include "local_solver.hpp"
+#include "bench_common.hpp"
+
+using RealType = double;
+
+/* Condition number of a symmetric positive definite matrix */
+RealType
+spd_condition(const arma::Mat<RealType>& A)
+{
+    arma::Col<RealType> ev = arma::eig_sym(A);
+    return ev.max() / ev.min();
+}
+
+template<typename Family>
+void
+run(const std::string& name, size_t k, const std::vector<element<RealType>>& mesh)
+{
+    hho_local_operator<RealType, Family>    lop(k);
+    moment_table<RealType, Family>          moments(k+1);
+    
+    RealType sink = 0.;
+    size_t cs = k+1;
+    
+    auto t_build = time_per_element(mesh, [&](const element<RealType>& elem) {
+        lop.build(elem);
+        sink += lop.local_contrib()(0,0);
+    }, 3);
+    
+    /* Local solve with the K_TT of each element, for the solution of ones:
+     * the matrices and the right hand sides are built before timing */
+    std::vector<arma::Mat<RealType>> K_TTs;
+    std::vector<arma::Col<RealType>> rhss;
+    arma::Col<RealType> ones(cs);
+    ones.ones();
+    for (auto& elem : mesh)
+    {
+        lop.build(elem);
+        K_TTs.push_back( lop.local_contrib().submat(0, 0, arma::size(cs, cs)) );
+        rhss.push_back( K_TTs.back() * ones );
+    }
+    
+    RealType err = 0.;
+    size_t elem_num = 0;
+    auto t_solve = time_per_element(mesh, [&](const element<RealType>&) {
+        auto i = elem_num++ % mesh.size();
+        arma::Col<RealType> x = spd_solver<RealType>(K_TTs[i]).solve(rhss[i]);
+        err = std::max(err, RealType(norm(x - ones) / norm(ones)));
+    }, 3);
+    
+    const arma::Mat<RealType>& K_TT = K_TTs.front();
+    
+    std::cout << std::setw(6) << k << std::setw(11) << name
+              << std::setw(13) << t_build << std::setw(13) << t_solve
+              << std::setw(13) << spd_condition(moments.reference_mass())
+              << std::setw(13) << spd_condition(K_TT)
+              << std::setw(13) << err;
+    
+    print_sink(std::cout, sink);
+    
+    std::cout << std::endl;
+}
+
+int
+main(int argc, char **argv)
+{
+    size_t max_degree = (argc > 1) ? atoi(argv[1]) : 16;
+    size_t num_elements = (argc > 2) ? atoi(argv[2]) : 1000;
+    
+    auto mesh = make_mesh<RealType>(num_elements);
+    
+    std::cout << "degree      basis   build [ns]   solve [ns]     cond(M)   cond(K_TT)   solve error" << std::endl;
+    
+    for (size_t k = 2; k <= max_degree; k += 2)
+    {
+        run<scaled_monomials>("monomial", k, mesh);
+        run<scaled_legendre>("legendre", k, mesh);
+    }
+    
+    return 0;
+}
@@ -0,0 +1,84 @@
+/*
+ *       /\
+ *      /__\        Matteo Cicuttin (C) 2016 - matteo.cicuttin@enpc.fr
+ *     /_\/_\
+ *    /\    /\      École Nationale des Ponts et Chaussées
+ *   /__\  /__\     CERMICS
+ *  /_\/_\/_\/_\
+ *
+ * This is a simple 1D code for the demonstration of the Hybrid High Order
+ * numerical method. It is intended only to show the details of all the
+ * involved operators (projection, gradient reconstruction, stabilization)
+ * step by step.
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <vector>
+#include <ostream>
+
+#include <armadillo>
+
+#include "element.hpp"
+
+/* Uniform mesh of [0, 1] with num_elements elements */
+template<typename T>
+std::vector<element<T>>
+make_mesh(size_t num_elements)
+{
+    std::vector<element<T>> mesh;
+    mesh.reserve(num_elements);
+    for (size_t i = 0; i < num_elements; i++)
+        mesh.push_back( element<T>(T(i)/num_elements, T(i+1)/num_elements) );
+    
+    return mesh;
+}
+
+/* The timed loops accumulate something of their results into a sink; it is
+ * printed (as a mark, for a value which does not occur) so that the loops
+ * are not optimized away */
+template<typename T>
+void
+print_sink(std::ostream& os, T sink)
+{
+    if (sink == T(0.123456789))
+        os << " *";
+}
+
+/* Run fn on all the elements a few times and return the best time per
+ * element, in nanoseconds */
+template<typename T, typename Function>
+double
+time_per_element(const std::vector<element<T>>& mesh, const Function& fn,
+                 size_t repeats = 5)
+{
+    double best = 0.;
+    
+    for (size_t r = 0; r < repeats; r++)
+    {
+        arma::wall_clock timer;
+        timer.tic();
+        for (auto& elem : mesh)
+            fn(elem);
+        double t = timer.toc();
+        
+        if (r == 0 or t < best)
+            best = t;
+    }
+    
+    return 1e9 * best / mesh.size();
+}
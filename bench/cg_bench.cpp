@@ -0,0 +1,125 @@
+/*
+ *       /\
+ *      /__\        Matteo Cicuttin (C) 2016 - matteo.cicuttin@enpc.fr
+ *     /_\/_\
+ *    /\    /\      École Nationale des Ponts et Chaussées
+ *   /__\  /__\     CERMICS
+ *  /_\/_\/_\/_\
+ *
+ * This is a simple 1D code for the demonstration of the Hybrid High Order
+ * numerical method. It is intended only to show the details of all the
+ * involved operators (projection, gradient reconstruction, stabilization)
+ * step by step.
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Benchmark of the preconditioners of the CG on the face system of the
+ * diffusion problem: for each number of elements it reports the iterations
+ * and the time (setup of the preconditioner plus solve) with each of them.
+ * The system is the SPD one used by -s pcg, with the Dirichlet faces
+ * eliminated.
+ *
+ *   cg-bench [degree] [max_elements]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <cmath>
+
+#include "common.h"
+#include "element.hpp"
+#include "projector.hpp"
+#include "local_operator_cache.hpp"
+#include "face_assembler.hpp"
+#include "conjugate_gradient.hpp"
+#include "bench_common.hpp"
+
+using RealType = double;
+
+template<typename Preconditioner>
+void
+run(const char *name, const arma::SpMat<RealType>& A, const arma::Col<RealType>& b,
+    const arma::Col<RealType>& ref)
+{
+    solver_control<RealType> ctl(1e-9, 2*A.n_cols);
+    ctl.log = nullptr;
+    solver_info<RealType> info;
+    
+    arma::wall_clock timer;
+    timer.tic();
+    Preconditioner precond(A);
+    arma::Col<RealType> x = conjugate_gradient(A, b, precond, ctl, info);
+    double t = timer.toc();
+    
+    RealType err = norm(x - ref) / norm(ref);
+    std::cout << std::setw(10) << name << std::setw(8) << info.iterations
+              << std::setw(14) << t*1e3 << std::setw(14) << err << std::endl;
+}
+
+int
+main(int argc, char **argv)
+{
+    size_t degree = (argc > 1) ? atoi(argv[1]) : 1;
+    size_t max_elements = (argc > 2) ? atoi(argv[2]) : 16384;
+    
+    /* Not the load of the diffusion example: on a uniform mesh sin(pi x)
+     * gives a right hand side which is an eigenvector of the face system,
+     * and the CG would converge in one iteration */
+    auto pf = [](RealType x) -> RealType {
+        return exp(x) * (1 + 10*x*x);
+    };
+    
+    projector<RealType>             proj(degree);
+    local_operator_cache<RealType>  cache(degree);
+    
+    for (size_t N = 16; N <= max_elements; N *= 4)
+    {
+        auto mesh = make_mesh<RealType>(N);
+        face_system_assembler<RealType> assembler(N);
+        arma::Col<RealType> b(N+1);
+        b.zeros();
+        
+        for (size_t i = 0; i < N; i++)
+        {
+            auto& elem = mesh[i];
+            arma::Col<RealType> projection = proj.rhs(elem, pf);
+            arma::Col<RealType> bC = cache.condensed_rhs(projection);
+            
+            assembler.add(i, cache.condensed_matrix(elem));
+            b(i) += bC(0);
+            b(i+1) += bC(1);
+        }
+        
+        b(0) = 0;
+        b(N) = 0;
+        
+        arma::SpMat<RealType> A = assembler.dirichlet_matrix();
+        
+        /* Reference solution, from the exact factorization */
+        incomplete_cholesky_preconditioner<RealType> chol(A);
+        arma::Col<RealType> ref = chol.apply(b);
+        
+        std::cout << "N = " << N << ", k = " << degree << std::endl;
+        std::cout << "   precond   iters     time [ms]     rel error" << std::endl;
+        run<identity_preconditioner<RealType>>("none", A, b, ref);
+        run<jacobi_preconditioner<RealType>>("jacobi", A, b, ref);
+        run<ssor_preconditioner<RealType>>("ssor", A, b, ref);
+        run<incomplete_cholesky_preconditioner<RealType>>("ic", A, b, ref);
+    }
+    
+    return 0;
+}
@@ -0,0 +1,376 @@
+/*
+ *       /\
+ *      /__\        Matteo Cicuttin (C) 2016 - matteo.cicuttin@enpc.fr
+ *     /_\/_\
+ *    /\    /\      École Nationale des Ponts et Chaussées
+ *   /__\  /__\     CERMICS
+ *  /_\/_\/_\/_\
+ *
+ * This is a simple 1D code for the demonstration of the Hybrid High Order
+ * numerical method. It is intended only to show the details of all the
+ * involved operators (projection, gradient reconstruction, stabilization)
+ * step by step.
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Benchmark of the diffusion example: it sweeps the degree, the number of
+ * elements and the number of threads, repeats each configuration and
+ * reports the throughput of the assembly (local operators, condensation and
+ * construction of the face system), of the solve of the face system and of
+ * postprocess, in elements and in DOFs (cell and face unknowns) per second.
+ *
+ *   hho-bench [-k degrees] [-n elements] [-t threads] [-c cache]
+ *             [-r repeats] [-s solver] [-b basis] [-o file.csv]
+ *
+ * The lists are comma separated, for example -k 0,1,2 -n 1000,100000; with
+ * -c on,off each configuration is run with and without the cache of the
+ * local operators, so that the two can be compared directly. The
+ * times are the median over the repetitions, after one run which is not
+ * measured; the spread is (max - min) / median. With -o the results are
+ * also written as CSV, one line per configuration and phase.
+ *
+ * The results must not depend on the number of threads: the errors of each
+ * configuration are compared bit by bit with the ones of the first number of
+ * threads in the list, and hho-bench exits with status 1 if they differ.
+ * -c off -t 1,4 checks this for the kernels which rebuild the operators.
+ *
+ * The phases are measured with the timers of profiler.hpp, so this target
+ * is always compiled with HHO_PROFILING. The per-element timers are left
+ * off, as they would slow down the assembly.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <map>
+#include <tuple>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <unistd.h>
+
+#include "common.h"
+#include "diffusion_demo.hpp"
+#include "profiler.hpp"
+
+using RealType = double;
+
+static std::vector<size_t>
+parse_list(const char *str)
+{
+    std::vector<size_t> ret;
+    std::stringstream ss(str);
+    std::string item;
+    while ( std::getline(ss, item, ',') )
+        if (not item.empty())
+            ret.push_back( size_t(atof(item.c_str())) );
+    
+    return ret;
+}
+
+/* "on" and "off" in a comma separated list, anything else is ignored */
+static std::vector<bool>
+parse_switch_list(const char *str)
+{
+    std::vector<bool> ret;
+    std::stringstream ss(str);
+    std::string item;
+    while ( std::getline(ss, item, ',') )
+    {
+        if (item == "on")
+            ret.push_back(true);
+        else if (item == "off")
+            ret.push_back(false);
+    }
+    
+    return ret;
+}
+
+struct phase_times
+{
+    std::vector<double>     assembly, solve, postprocess;
+    RealType                l2_err, l2_err_func;
+};
+
+/* One run of the diffusion example, the same problem as hho-demo-1d */
+template<typename Family>
+void
+run_once(const run_parameters& rp, phase_times& times)
+{
+    auto pf = [](RealType x) -> RealType {
+        return 3.141592*3.141592*sin(3.141592*x);
+    };
+    
+    auto sf = [](RealType x) -> RealType {
+        return sin(3.141592*x);
+    };
+    
+    profiler::instance().reset();
+    
+    auto mesh = generate_mesh<RealType>(rp.num_elements);
+    condensation_store<RealType> store;
+    auto x = solve_diffusion_problem<RealType, Family>(rp, pf, mesh, &store);
+    auto pp = postprocess<RealType, Family>(rp, x, pf, sf, mesh, &store);
+    times.l2_err = std::get<2>(pp);
+    times.l2_err_func = std::get<3>(pp);
+    
+    /* The construction of the multigrid levels is part of the solve */
+    auto& prof = profiler::instance();
+    double solve = prof.seconds("diffusion/solve/global solver") +
+                   prof.seconds("diffusion/solve/multigrid levels");
+    
+    times.assembly.push_back( prof.seconds("diffusion/solve") - solve );
+    times.solve.push_back( solve );
+    times.postprocess.push_back( prof.seconds("diffusion/postprocess") );
+}
+
+static double
+median(std::vector<double> v)
+{
+    std::sort(v.begin(), v.end());
+    size_t n = v.size();
+    return (n % 2) ? v[n/2] : (v[n/2-1] + v[n/2])/2;
+}
+
+static void
+report(std::ostream *csv, const run_parameters& rp, const char *solver,
+       const char *phase, const std::vector<double>& t)
+{
+    double med = median(t);
+    double spread = (*std::max_element(t.begin(), t.end()) -
+                     *std::min_element(t.begin(), t.end())) / med;
+    
+    double elements = rp.num_elements;
+    double dofs = rp.num_elements * (rp.degree + 1) + rp.num_elements + 1;
+    
+    std::cout << std::setw(4) << rp.degree << std::setw(10) << rp.num_elements
+              << std::setw(5) << rp.num_threads << std::setw(6)
+              << (rp.cache_operators ? "on" : "off") << "  " << std::left
+              << std::setw(13) << phase << std::right
+              << std::setw(14) << med*1e3 << std::setw(9) << std::fixed
+              << std::setprecision(1) << 100*spread << "%" << std::scientific
+              << std::setprecision(3) << std::setw(13) << elements/med
+              << std::setw(13) << dofs/med << std::endl;
+    std::cout.unsetf(std::ios::floatfield);
+    std::cout << std::setprecision(6);
+    
+    if (csv)
+    {
+        *csv << rp.degree << "," << rp.num_elements << "," << rp.num_threads
+             << "," << (rp.cache_operators ? "on" : "off") << "," << solver << "," << phase << "," << t.size() << ","
+             << std::setprecision(9) << med << ","
+             << *std::min_element(t.begin(), t.end()) << ","
+             << *std::max_element(t.begin(), t.end()) << ","
+             << elements/med << "," << dofs/med << std::setprecision(6)
+             << std::endl;
+    }
+}
+
+static void
+usage(const char *progname)
+{
+    std::cout << progname << " [options]" << std::endl;
+    std::cout << " -k <degrees>     Degrees to test. Default = 0,1,2,3." << std::endl;
+    std::cout << " -n <elements>    Numbers of elements. Default = 1000,10000,100000." << std::endl;
+    std::cout << " -t <threads>     Numbers of threads. Default = 1." << std::endl;
+    std::cout << " -c <cache>       Operator cache, on and/or off. Default = on." << std::endl;
+    std::cout << " -r <repeats>     Measured runs of each configuration. Default = 5." << std::endl;
+    std::cout << " -s <solver>      cg, pcg (with IC), tridiag or mg. Default = tridiag." << std::endl;
+    std::cout << " -b <basis>       monomial or legendre. Default = monomial." << std::endl;
+    std::cout << " -o <filename>    Also write the results as CSV." << std::endl;
+}
+
+int
+main(int argc, char **argv)
+{
+    std::vector<size_t> degrees = { 0, 1, 2, 3 };
+    std::vector<size_t> elements = { 1000, 10000, 100000 };
+    std::vector<size_t> threads = { 1 };
+    std::vector<bool> caches = { true };
+    size_t repeats = 5;
+    const char *csv_filename = nullptr;
+    bool legendre = false;
+    
+    run_parameters rp;
+    rp.filename         = nullptr;
+    rp.draw             = false;
+    rp.eval_per_elem    = 5;
+    rp.family           = basis_family::MONOMIALS;
+    rp.solver           = global_solver::TRIDIAGONAL;
+    rp.preconditioner   = preconditioner_type::NONE;
+    rp.mg_cycle         = multigrid_cycle::V;
+    rp.mg_smoother      = multigrid_smoother::GAUSS_SEIDEL;
+    rp.cache_operators  = true;
+    rp.quiet            = true;
+    const char *solver = "tridiag";
+    
+    int ch;
+    while ( (ch = getopt(argc, argv, "b:c:hk:n:o:r:s:t:")) != -1 )
+    {
+        switch (ch)
+        {
+            case 'b':
+                legendre = (strcmp(optarg, "legendre") == 0);
+                rp.family = legendre ? basis_family::LEGENDRE : basis_family::MONOMIALS;
+                break;
+            
+            case 'c':
+                caches = parse_switch_list(optarg);
+                if (caches.empty())
+                {
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            
+            case 'k':
+                degrees = parse_list(optarg);
+                break;
+            
+            case 'n':
+                elements = parse_list(optarg);
+                break;
+            
+            case 'o':
+                csv_filename = optarg;
+                break;
+            
+            case 'r':
+                repeats = std::max(atoi(optarg), 1);
+                break;
+            
+            case 's':
+                if ( strcmp(optarg, "cg") == 0 )
+                {
+                    rp.solver = global_solver::CG;
+                    solver = "cg";
+                }
+                else if ( strcmp(optarg, "pcg") == 0 )
+                {
+                    rp.solver = global_solver::PCG;
+                    rp.preconditioner = preconditioner_type::INCOMPLETE_CHOLESKY;
+                    solver = "pcg";
+                }
+                else if ( strcmp(optarg, "mg") == 0 )
+                {
+                    rp.solver = global_solver::MULTIGRID;
+                    solver = "mg";
+                }
+                else
+                {
+                    rp.solver = global_solver::TRIDIAGONAL;
+                    solver = "tridiag";
+                }
+                break;
+            
+            case 't':
+                threads = parse_list(optarg);
+                break;
+            
+            case 'h':
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+    
+    std::ofstream csv_file;
+    std::ostream *csv = nullptr;
+    if (csv_filename)
+    {
+        csv_file.open(csv_filename);
+        if (not csv_file.is_open())
+        {
+            std::cout << "Cannot open " << csv_filename << std::endl;
+            return 1;
+        }
+        csv = &csv_file;
+        *csv << "degree,elements,threads,cache,solver,phase,repeats,median_s,min_s,max_s,"
+             << "elements_per_s,dofs_per_s" << std::endl;
+    }
+    
+    /* Only the phases, not the per-element timers */
+    profiler::instance().enable(true, false);
+    
+    std::cout << "solver = " << solver << ", basis = "
+              << (legendre ? "legendre" : "monomial") << ", "
+              << repeats << " repeats" << std::endl;
+    std::cout << "   k         n  thr cache  phase           median [ms]   spread"
+              << "       elem/s        DOF/s" << std::endl;
+    
+    /* Errors with the first number of threads, by degree, elements and
+     * cache */
+    std::map<std::tuple<size_t, size_t, bool>, std::pair<RealType, RealType>> ref_errors;
+    bool thread_independent = true;
+    
+    for (auto k : degrees)
+    {
+        for (auto n : elements)
+        {
+            for (auto t : threads)
+            {
+                for (auto c : caches)
+                {
+                    rp.degree = k;
+                    rp.num_elements = std::max(n, size_t(1));
+                    rp.num_threads = std::max(t, size_t(1));
+                    rp.cache_operators = c;
+                    
+                    phase_times times, warmup;
+                    for (size_t r = 0; r < repeats+1; r++)
+                    {
+                        if (legendre)
+                            run_once<scaled_legendre>(rp, r == 0 ? warmup : times);
+                        else
+                            run_once<scaled_monomials>(rp, r == 0 ? warmup : times);
+                    }
+                    
+                    report(csv, rp, solver, "assembly", times.assembly);
+                    report(csv, rp, solver, "solve", times.solve);
+                    report(csv, rp, solver, "postprocess", times.postprocess);
+                    
+                    auto errs = std::make_pair(times.l2_err, times.l2_err_func);
+                    auto key = std::make_tuple(k, n, bool(c));
+                    auto ref = ref_errors.find(key);
+                    if (ref == ref_errors.end())
+                        ref_errors[key] = errs;
+                    else if ((*ref).second != errs)
+                    {
+                        std::cout << "  errors differ from the first thread count: "
+                                  << std::setprecision(17) << errs.first << " "
+                                  << errs.second << " against "
+                                  << (*ref).second.first << " "
+                                  << (*ref).second.second << std::setprecision(6)
+                                  << std::endl;
+                        thread_independent = false;
+                    }
+                }
+            }
+        }
+    }
+    
+    if (not thread_independent)
+    {
+        std::cout << "The results depend on the number of threads" << std::endl;
+        return 1;
+    }
+    
+    return 0;
+}
@@ -0,0 +1,93 @@
+/*
+ *       /\
+ *      /__\        Matteo Cicuttin (C) 2016 - matteo.cicuttin@enpc.fr
+ *     /_\/_\
+ *    /\    /\      École Nationale des Ponts et Chaussées
+ *   /__\  /__\     CERMICS
+ *  /_\/_\/_\/_\
+ *
+ * This is a simple 1D code for the demonstration of the Hybrid High Order
+ * numerical method. It is intended only to show the details of all the
+ * involved operators (projection, gradient reconstruction, stabilization)
+ * step by step.
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Microbenchmark of the construction of the local operators: for each degree
+ * it times gradient_reconstruction_operator followed by
+ * stabilization_operator against the fused hho_local_operator, on the same
+ * sequence of elements.
+ *
+ *   local-operator-bench [max_degree] [num_elements]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+
+#include "element.hpp"
+#include "gradient_reconstruction.hpp"
+#include "stabilization.hpp"
+#include "hho_local_operator.hpp"
+#include "bench_common.hpp"
+
+using RealType = double;
+
+int
+main(int argc, char **argv)
+{
+    size_t max_degree = (argc > 1) ? atoi(argv[1]) : 10;
+    size_t num_elements = (argc > 2) ? atoi(argv[2]) : 10000;
+    
+    auto mesh = make_mesh<RealType>(num_elements);
+    
+    std::cout << "degree   separate [ns]   fused [ns]   speedup   max |diff|" << std::endl;
+    
+    for (size_t k = 0; k <= max_degree; k++)
+    {
+        gradient_reconstruction_operator<RealType>  gr(k);
+        stabilization_operator<RealType>            stab(k);
+        hho_local_operator<RealType>                lop(k);
+        
+        RealType sink = 0.;
+        
+        auto t_sep = time_per_element(mesh, [&](const element<RealType>& elem) {
+            gr.build(elem);
+            stab.build(elem, gr.as_matrix());
+            arma::Mat<RealType> LC = gr.local_contrib() + stab.local_contrib();
+            sink += LC(0,0);
+        });
+        
+        auto t_fus = time_per_element(mesh, [&](const element<RealType>& elem) {
+            lop.build(elem);
+            sink += lop.local_contrib()(0,0);
+        });
+        
+        /* Check that the two give the same operator */
+        arma::Mat<RealType> LC = gr.local_contrib() + stab.local_contrib();
+        RealType diff = arma::abs(LC - lop.local_contrib()).max() / arma::abs(LC).max();
+        
+        std::cout << std::setw(6) << k << std::setw(18) << t_sep
+                  << std::setw(13) << t_fus << std::setw(10) << t_sep/t_fus
+                  << std::setw(13) << diff;
+        
+        print_sink(std::cout, sink);
+        
+        std::cout << std::endl;
+    }
+    
+    return 0;
+}
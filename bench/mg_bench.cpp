@@ -0,0 +1,167 @@
+/*
+ *       /\
+ *      /__\        Matteo Cicuttin (C) 2016 - matteo.cicuttin@enpc.fr
+ *     /_\/_\
+ *    /\    /\      École Nationale des Ponts et Chaussées
+ *   /__\  /__\     CERMICS
+ *  /_\/_\/_\/_\
+ *
+ * This is a simple 1D code for the demonstration of the Hybrid High Order
+ * numerical method. It is intended only to show the details of all the
+ * involved operators (projection, gradient reconstruction, stabilization)
+ * step by step.
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Scaling benchmark of the multigrid solver of the face system: for each
+ * number of elements it reports the number of levels, the number of cycles
+ * and the time to assemble the levels and to solve, with the V and the W
+ * cycle and Gauss-Seidel smoothing, together with the final relative
+ * residual and whether it reached the tolerance. With a working multigrid
+ * the number of cycles to converge does not depend on N, and the time grows
+ * linearly; only the rows marked "yes" tell the number of cycles to converge.
+ *
+ *   mg-bench [degree] [max_elements]
+ *
+ * max_elements can be as large as 1e8, memory permitting: the mesh, the
+ * levels and the vectors take a few hundred bytes per element. On large
+ * meshes the relative residual 1e-9 is below round-off: the solver stops
+ * when it stagnates, the row is marked "no" and its number of cycles is only
+ * the number done before the stagnation. The error against the tridiagonal
+ * solve, which has round-off of the same order, then grows like N^2.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <cmath>
+
+#include "common.h"
+#include "element.hpp"
+#include "projector.hpp"
+#include "local_operator_cache.hpp"
+#include "multigrid.hpp"
+#include "bench_common.hpp"
+
+using RealType = double;
+
+void
+run(const char *name, multigrid_cycle cyc, const run_parameters& rp,
+    const std::vector<element<RealType>>& mesh,
+    const local_operator_cache<RealType>& cache,
+    const arma::Col<RealType>& lower, const arma::Col<RealType>& diag,
+    const arma::Col<RealType>& upper, const arma::Col<RealType>& b,
+    const arma::Col<RealType>& ref)
+{
+    arma::wall_clock timer;
+    timer.tic();
+    face_multigrid<RealType> mg(0, 1, cyc, multigrid_smoother::GAUSS_SEIDEL);
+    mg.add_level(lower, diag, upper, interior_faces(mesh));
+    std::vector<element<RealType>> level_mesh = coarsen_mesh(mesh);
+    while (level_mesh.size() >= 2)
+    {
+        arma::Col<RealType> cl, cd, cu;
+        assemble_interior_system<RealType, scaled_monomials>(rp, level_mesh, cache,
+                                                             cl, cd, cu);
+        mg.add_level(cl, cd, cu, interior_faces(level_mesh));
+        
+        if (level_mesh.size() == 2)
+            break;
+        
+        level_mesh = coarsen_mesh(level_mesh);
+    }
+    double t_setup = timer.toc();
+    
+    solver_control<RealType> ctl(1e-9);
+    ctl.log = nullptr;
+    solver_info<RealType> info;
+    
+    timer.tic();
+    arma::Col<RealType> x = mg.solve(b, ctl, info);
+    double t_solve = timer.toc();
+    
+    RealType err = norm(x - ref) / norm(ref);
+    std::cout << std::setw(6) << name << std::setw(8) << mg.num_levels()
+              << std::setw(8) << info.iterations << std::setw(14) << t_setup*1e3
+              << std::setw(14) << t_solve*1e3 << std::setw(14) << info.relative_residual
+              << std::setw(11) << (info.converged ? "yes" : "no")
+              << std::setw(14) << err << std::endl;
+}
+
+int
+main(int argc, char **argv)
+{
+    size_t degree = (argc > 1) ? atoi(argv[1]) : 1;
+    size_t max_elements = (argc > 2) ? size_t(atof(argv[2])) : 1048576;
+    
+    /* Not sin(pi x), which on a uniform mesh gives a right hand side that
+     * is an eigenvector of the face system */
+    auto pf = [](RealType x) -> RealType {
+        return exp(x) * (1 + 10*x*x);
+    };
+    
+    run_parameters rp;
+    rp.filename         = nullptr;
+    rp.draw             = false;
+    rp.degree           = degree;
+    rp.num_elements     = 0;    /* not used, the meshes are built here */
+    rp.eval_per_elem    = 5;
+    rp.family           = basis_family::MONOMIALS;
+    rp.solver           = global_solver::MULTIGRID;
+    rp.preconditioner   = preconditioner_type::NONE;
+    rp.mg_cycle         = multigrid_cycle::V;
+    rp.mg_smoother      = multigrid_smoother::GAUSS_SEIDEL;
+    rp.num_threads      = 1;
+    rp.cache_operators  = true;
+    rp.quiet            = true;
+    
+    projector<RealType>             proj(degree);
+    local_operator_cache<RealType>  cache(degree);
+    
+    for (size_t N = 16; N <= max_elements; N *= 4)
+    {
+        auto mesh = make_mesh<RealType>(N);
+        
+        arma::wall_clock timer;
+        timer.tic();
+        arma::Col<RealType> lower, diag, upper;
+        assemble_interior_system<RealType, scaled_monomials>(rp, mesh, cache,
+                                                             lower, diag, upper);
+        arma::Col<RealType> b(N-1);
+        b.zeros();
+        for (size_t i = 0; i < N; i++)
+        {
+            arma::Col<RealType> bC = cache.condensed_rhs( proj.rhs(mesh[i], pf) );
+            if (i > 0)
+                b(i-1) += bC(0);
+            if (i < N-1)
+                b(i) += bC(1);
+        }
+        double t_assembly = timer.toc();
+        
+        /* Reference solution */
+        arma::Col<RealType> ref = tridiagonal_solve(lower, diag, upper, b);
+        
+        std::cout << "N = " << N << ", k = " << degree << ", fine level assembly "
+                  << t_assembly*1e3 << " ms" << std::endl;
+        std::cout << " cycle  levels  cycles    setup [ms]    solve [ms]"
+                  << "      residual  converged     rel error" << std::endl;
+        run("V", multigrid_cycle::V, rp, mesh, cache, lower, diag, upper, b, ref);
+        run("W", multigrid_cycle::W, rp, mesh, cache, lower, diag, upper, b, ref);
+    }
+    
+    return 0;
+}
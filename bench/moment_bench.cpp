@@ -0,0 +1,171 @@
+/*
+ *       /\
+ *      /__\        Matteo Cicuttin (C) 2016 - matteo.cicuttin@enpc.fr
+ *     /_\/_\
+ *    /\    /\      École Nationale des Ponts et Chaussées
+ *   /__\  /__\     CERMICS
+ *  /_\/_\/_\/_\
+ *
+ * This is a simple 1D code for the demonstration of the Hybrid High Order
+ * numerical method. It is intended only to show the details of all the
+ * involved operators (projection, gradient reconstruction, stabilization)
+ * step by step.
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Microbenchmark of the construction of the element mass and stiffness
+ * matrices: for each degree it times the quadrature loop over the tabulated
+ * basis with one rank-1 update per node, the same quadrature as a single
+ * weighted product B^T W B, and the scaling of the exact moment tables of
+ * moment_table.hpp, for both bases. The library builds its local matrices
+ * from the moment tables only; the two quadrature variants are kept here as
+ * the reference they are measured and checked against.
+ *
+ *   moment-bench [max_degree] [num_elements]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <string>
+#include <cmath>
+
+#include "element.hpp"
+#include "basis.hpp"
+#include "quadrature.hpp"
+#include "moment_table.hpp"
+#include "bench_common.hpp"
+
+using RealType = double;
+
+/* B^T diag(w) B, for tabulated values B (points x basis) and nonnegative
+ * weights w, as the single product C^T C with C = diag(sqrt(w)) B. This is
+ * the symmetric rank-k update of BLAS (syrk), so with a vendor BLAS the whole
+ * local matrix is one call. */
+template<typename T>
+arma::Mat<T>
+weighted_gram(const arma::Mat<T>& B, const arma::Col<T>& w)
+{
+    arma::Mat<T> C = B;
+    for (size_t i = 0; i < C.n_rows; i++)
+        C.row(i) *= std::sqrt(w(i));
+    
+    return C.t() * C;
+}
+
+template<typename Family>
+void
+run(const std::string& name, size_t max_degree,
+    const std::vector<element<RealType>>& mesh)
+{
+    std::cout << name << std::endl;
+    std::cout << "degree   rank-1 [ns]   B^T W B [ns]   moments [ns]   speedup   max rel diff" << std::endl;
+    
+    for (size_t k = 0; k <= max_degree; k++)
+    {
+        basis<RealType, Family>         bas(k);
+        quadrature<RealType>            quad(2*k);
+        moment_table<RealType, Family>  moments(bas.size());
+        
+        /* The basis and its gradients (times h) at the nodes of the
+         * reference element, of measure 1, and the weights there */
+        element<RealType> ref_elem(-0.5, 0.5);
+        std::vector<arma::Col<RealType>> phis, dphis;
+        for (auto qp : quad.map(ref_elem))
+        {
+            phis.push_back( bas.eval_functions(ref_elem, qp.first) );
+            dphis.push_back( bas.eval_gradients(ref_elem, qp.first) );
+        }
+        
+        arma::Mat<RealType> B(phis.size(), bas.size()), dB(phis.size(), bas.size());
+        arma::Col<RealType> w(phis.size());
+        size_t inode = 0;
+        for (auto qp : quad.map(ref_elem))
+        {
+            B.row(inode) = phis[inode].t();
+            dB.row(inode) = dphis[inode].t();
+            w(inode) = qp.second;
+            inode++;
+        }
+        
+        arma::Mat<RealType> Mq, Kq, Mg, Kg, Mm, Km;
+        RealType sink = 0.;
+        
+        auto t_quad = time_per_element(mesh, [&](const element<RealType>& elem) {
+            auto h = elem.measure();
+            Mq.zeros(bas.size(), bas.size());
+            Kq.zeros(bas.size(), bas.size());
+            
+            size_t iqp = 0;
+            for (auto qp : quad.map(elem))
+            {
+                auto qweight = qp.second;
+                
+                auto& phi = phis[iqp];
+                auto& dphi = dphis[iqp];
+                iqp++;
+                
+                Mq += qweight * phi * phi.t();
+                Kq += (qweight/(h*h)) * dphi * dphi.t();
+            }
+            sink += Mq(0,0) + Kq(0,0);
+        });
+        
+        auto t_gram = time_per_element(mesh, [&](const element<RealType>& elem) {
+            auto h = elem.measure();
+            Mg = h * weighted_gram(B, w);
+            Kg = weighted_gram(dB, w) / h;
+            sink += Mg(0,0) + Kg(0,0);
+        });
+        
+        auto t_mom = time_per_element(mesh, [&](const element<RealType>& elem) {
+            Mm = moments.mass_matrix(elem);
+            Km = moments.stiffness_matrix(elem);
+            sink += Mm(0,0) + Km(0,0);
+        });
+        
+        /* All must agree up to the rounding of the quadrature, on the last
+         * element of the mesh */
+        RealType Kscale = std::max(arma::abs(Km).max(), 1.0);
+        RealType diff = std::max( arma::abs(Mq - Mm).max() / arma::abs(Mm).max(),
+                                  arma::abs(Kq - Km).max() / Kscale );
+        diff = std::max( diff, arma::abs(Mg - Mm).max() / arma::abs(Mm).max() );
+        diff = std::max( diff, arma::abs(Kg - Km).max() / Kscale );
+        
+        std::cout << std::setw(6) << k << std::setw(14) << t_quad
+                  << std::setw(15) << t_gram << std::setw(15) << t_mom
+                  << std::setw(10) << t_quad/t_mom << std::setw(15) << diff;
+        
+        print_sink(std::cout, sink);
+        
+        std::cout << std::endl;
+    }
+}
+
+int
+main(int argc, char **argv)
+{
+    size_t max_degree = (argc > 1) ? atoi(argv[1]) : 10;
+    size_t num_elements = (argc > 2) ? atoi(argv[2]) : 10000;
+    
+    auto mesh = make_mesh<RealType>(num_elements);
+    
+    run<scaled_monomials>("Scaled monomials", max_degree, mesh);
+    std::cout << std::endl;
+    run<scaled_legendre>("Scaled Legendre", max_degree, mesh);
+    
+    return 0;
+}
@@ -0,0 +1,127 @@
+/*
+ *       /\
+ *      /__\        Matteo Cicuttin (C) 2016 - matteo.cicuttin@enpc.fr
+ *     /_\/_\
+ *    /\    /\      École Nationale des Ponts et Chaussées
+ *   /__\  /__\     CERMICS
+ *  /_\/_\/_\/_\
+ *
+ * This is a simple 1D code for the demonstration of the Hybrid High Order
+ * numerical method. It is intended only to show the details of all the
+ * involved operators (projection, gradient reconstruction, stabilization)
+ * step by step.
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Microbenchmark of the construction of the quadrature rules: for each degree
+ * it integrates a function on every element of a mesh, building the rule of
+ * order 2k on each element, either from scratch with the Golub-Welsch
+ * algorithm (what quadrature<T> did before the rules were shared) or from
+ * the shared registry of gauss_legendre_rule(). The two must give the same
+ * integrals.
+ *
+ *   quadrature-bench [max_degree] [num_elements]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <cmath>
+
+#include "element.hpp"
+#include "quadrature.hpp"
+#include "bench_common.hpp"
+
+using RealType = double;
+
+/* Gauss-Legendre rule with num_points points on [-1, 1], computed from
+ * scratch: the eigenvalues of the Jacobi matrix are the nodes and the first
+ * components of its eigenvectors give the weights */
+std::vector<std::pair<RealType, RealType>>
+golub_welsch(size_t num_points)
+{
+    std::vector<std::pair<RealType, RealType>> qdata;
+    
+    if (num_points == 1)
+    {
+        qdata.push_back( std::make_pair(0., 2.) );
+        return qdata;
+    }
+    
+    arma::Col<RealType> vals(num_points-1);
+    for (size_t i = 0; i < vals.size(); i++)
+        vals(i) = std::sqrt( 1. / ( 4. - 1. / ((i+1)*(i+1)) ) );
+    
+    arma::Mat<RealType> M(num_points, num_points);
+    M.zeros();
+    M.diag(-1) = vals;
+    M.diag(+1) = vals;
+    
+    arma::Mat<RealType> eigvec;
+    arma::Col<RealType> eigval;
+    eig_sym(eigval, eigvec, M);
+    
+    for (size_t i = 0; i < num_points; i++)
+        qdata.push_back( std::make_pair(eigval(i), 2*eigvec(0,i)*eigvec(0,i)) );
+    
+    return qdata;
+}
+
+int
+main(int argc, char **argv)
+{
+    size_t max_degree = (argc > 1) ? atoi(argv[1]) : 10;
+    size_t num_elements = (argc > 2) ? atoi(argv[2]) : 10000;
+    
+    auto mesh = make_mesh<RealType>(num_elements);
+    
+    auto f = [](RealType x) -> RealType {
+        return std::exp(x) * std::cos(3*x);
+    };
+    
+    std::cout << "degree   points   fresh [ns]   cached [ns]   speedup   |diff|" << std::endl;
+    
+    for (size_t k = 0; k <= max_degree; k++)
+    {
+        size_t num_points = quadrature<RealType>(2*k).integrate(mesh[0]).size();
+        RealType int_fresh = 0., int_cached = 0.;
+        
+        auto t_fresh = time_per_element(mesh, [&](const element<RealType>& elem) {
+            auto rule = golub_welsch(num_points);
+            auto h = elem.measure();
+            auto x0 = elem.points()[0];
+            for (auto& qd : rule)
+                int_fresh += qd.second * 0.5 * h * f( (qd.first+1)*0.5*h + x0 );
+        });
+        
+        auto t_cached = time_per_element(mesh, [&](const element<RealType>& elem) {
+            quadrature<RealType> quad(2*k);
+            for (auto qp : quad.map(elem))
+                int_cached += qp.second * f(qp.first);
+        });
+        
+        /* Both accumulated the integral over the mesh the same number of
+         * times */
+        RealType diff = std::abs(int_fresh - int_cached) / std::abs(int_cached);
+        
+        std::cout << std::setw(6) << k << std::setw(9) << num_points
+                  << std::setw(13) << t_fresh << std::setw(14) << t_cached
+                  << std::setw(10) << t_fresh/t_cached << std::setw(13) << diff
+                  << std::endl;
+    }
+    
+    return 0;
+}
@@ -28,12 +28,55 @@
 
 #pragma once
 
+enum class basis_family
+{
+    MONOMIALS,
+    LEGENDRE
+};
+
+enum class global_solver
+{
+    CG,
+    PCG,
+    TRIDIAGONAL,
+    MULTIGRID,
+    STREAMING
+};
+
+enum class preconditioner_type
+{
+    NONE,
+    JACOBI,
+    SSOR,
+    INCOMPLETE_CHOLESKY
+};
+
+enum class multigrid_cycle
+{
+    V,
+    W
+};
+
+enum class multigrid_smoother
+{
+    JACOBI,
+    GAUSS_SEIDEL
+};
+
 struct run_parameters
 {
-    int         degree;
-    int         num_elements;
-    int         eval_per_elem;
-    char *      filename;
-    bool        draw;
+    int                 degree;
+    int                 num_elements;
+    int                 eval_per_elem;
+    char *              filename;
+    bool                draw;
+    basis_family        family;
+    global_solver       solver;
+    preconditioner_type preconditioner;
+    multigrid_cycle     mg_cycle;
+    multigrid_smoother  mg_smoother;
+    int                 num_threads;
+    bool                cache_operators;
+    bool                quiet;
 };
 
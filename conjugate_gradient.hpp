@@ -32,6 +32,210 @@
 #include <armadillo>
 #include <algorithm>
 #include <cassert>
+#include <cmath>
+
+#include "preconditioners.hpp"
+#include "solver_info.hpp"
+
+/* All the solvers come in two versions. The first takes a solver_control
+ * and fills a solver_info with the statistics of the solve; the second is
+ * the short form with eps and maxit, which logs on std::cout. */
+
+/* The same unpreconditioned CG, written for large systems. All the work
+ * vectors are allocated once before the iterations, and the vector
+ * operations are fused so that each iteration goes through memory as few
+ * times as possible:
+ *
+ *  - Ad = A d and dot(d, Ad) in the same pass;
+ *  - the updates of x and r and the new dot(r, r) in one pass;
+ *  - the update of d in one pass;
+ *  - the residual norm is sqrt(dot(r, r)), which is already known.
+ *
+ * The product goes through the columns of A and computes (A^T d)_j as the
+ * dot product of column j with d, so it relies on A being symmetric, as the
+ * CG does anyway. Its time, with the dot product fused in it, is counted
+ * as SpMV.
+ */
+template<typename T>
+arma::Col<T>
+fused_conjugate_gradient(const arma::SpMat<T>& A, const arma::Col<T>& b,
+                         const solver_control<T>& ctl, solver_info<T>& info)
+{
+    assert(A.n_cols == A.n_rows);
+    assert(b.n_elem == A.n_rows);
+    
+    solver_stopwatch sw;
+    info = solver_info<T>();
+    
+    size_t n = b.n_elem;
+    
+    arma::Col<T> x(n), r(n), d(n), Ad(n);
+    T *px = x.memptr(), *pr = r.memptr(), *pd = d.memptr(), *pAd = Ad.memptr();
+    
+    const T *values = A.values;
+    const arma::uword *row_indices = A.row_indices;
+    const arma::uword *col_ptrs = A.col_ptrs;
+    
+    T eps = ctl.eps;
+    size_t maxit = std::max(ctl.maxit, size_t(A.n_cols));
+    
+    if (ctl.log)
+        *ctl.log << "Starting CG. Target rr = " << eps << ", maxit = " << maxit << std::endl;
+    
+    /* x = 0, so r = d = b */
+    T dot_rr = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        px[i] = 0;
+        pr[i] = pd[i] = b(i);
+        dot_rr += b(i) * b(i);
+    }
+    
+    T res, res0;
+    res = res0 = std::sqrt(dot_rr);
+    solver_record(ctl, info, 0, res/res0);
+    sw.lap(info.vector_time);
+    
+    size_t iter = 0;
+    while ( (res/res0 > eps) and (iter++ < maxit) )
+    {
+        /* Ad = A d and dot(d, Ad) */
+        T dot_dAd = 0;
+        for (size_t j = 0; j < n; j++)
+        {
+            T s = 0;
+            for (size_t p = col_ptrs[j]; p < col_ptrs[j+1]; p++)
+                s += values[p] * pd[ row_indices[p] ];
+            pAd[j] = s;
+            dot_dAd += pd[j] * s;
+        }
+        sw.lap(info.spmv_time);
+        
+        T alpha = dot_rr/dot_dAd;
+        
+        /* x += alpha d, r -= alpha Ad and the new dot(r, r) */
+        T dot_rr_new = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            px[i] += alpha * pd[i];
+            pr[i] -= alpha * pAd[i];
+            dot_rr_new += pr[i] * pr[i];
+        }
+        
+        T beta = dot_rr_new/dot_rr;
+        dot_rr = dot_rr_new;
+        
+        for (size_t i = 0; i < n; i++)
+            pd[i] = pr[i] + beta * pd[i];
+        
+        res = std::sqrt(dot_rr);
+        sw.lap(info.vector_time);
+        
+        solver_record(ctl, info, iter, res/res0);
+    }
+    
+    info.iterations = std::min(iter, maxit);
+    info.relative_residual = res/res0;
+    info.converged = (iter <= maxit) and (res/res0 < eps);
+    info.total_time = info.spmv_time + info.vector_time;
+    solver_log_result(ctl, info, "iterations");
+    
+    return x;
+}
+
+template<typename T>
+arma::Col<T>
+fused_conjugate_gradient(const arma::SpMat<T>& A, const arma::Col<T>& b, T eps = 1e-8, size_t maxit = 0)
+{
+    solver_info<T> info;
+    return fused_conjugate_gradient(A, b, solver_control<T>(eps, maxit), info);
+}
+
+/* Preconditioned CG. The preconditioner P is an object with a method
+ * apply(r) that returns P^-1 r, see preconditioners.hpp. The stopping
+ * criterion is the same as in the unpreconditioned version, on the relative
+ * norm of the residual.
+ * See "An Introduction to the Conjugate Gradient Method Without
+ *      the Agonizing Pain" by J. R. Shewchuk
+ */
+template<typename T, typename Preconditioner>
+arma::Col<T>
+conjugate_gradient(const arma::SpMat<T>& A, const arma::Col<T>& b,
+                   const Preconditioner& P,
+                   const solver_control<T>& ctl, solver_info<T>& info)
+{
+    assert(A.n_cols == A.n_rows);
+    
+    solver_stopwatch sw;
+    info = solver_info<T>();
+    
+    arma::Col<T> d, r, x, z, Ad;
+    T alpha, beta;
+    T res, res0;
+    
+    T eps = ctl.eps;
+    size_t maxit = std::max(ctl.maxit, size_t(A.n_cols));
+    
+    if (ctl.log)
+        *ctl.log << "Starting CG. Target rr = " << eps << ", maxit = " << maxit << std::endl;
+    
+    x.resize(b.size());
+    x.zeros();
+    
+    r = b - A*x;
+    sw.lap(info.spmv_time);
+    z = P.apply(r);
+    sw.lap(info.precond_time);
+    d = z;
+    
+    T dot_rz = dot(r,z);
+    
+    res = res0 = norm(r);
+    solver_record(ctl, info, 0, res/res0);
+    sw.lap(info.vector_time);
+    
+    size_t iter = 0;
+    while ( (res/res0 > eps) and (iter++ < maxit) )
+    {
+        Ad = A * d;
+        sw.lap(info.spmv_time);
+        
+        alpha = dot_rz/dot(d, Ad);
+        x = x + alpha * d;
+        r = r - alpha * Ad;
+        sw.lap(info.vector_time);
+        
+        z = P.apply(r);
+        sw.lap(info.precond_time);
+        
+        T dot_rz_new = dot(r,z);
+        beta = dot_rz_new/dot_rz;
+        dot_rz = dot_rz_new;
+        d = z + beta * d;
+        
+        res = norm(r);
+        sw.lap(info.vector_time);
+        
+        solver_record(ctl, info, iter, res/res0);
+    }
+    
+    info.iterations = std::min(iter, maxit);
+    info.relative_residual = res/res0;
+    info.converged = (iter <= maxit) and (res/res0 < eps);
+    info.total_time = info.spmv_time + info.precond_time + info.vector_time;
+    solver_log_result(ctl, info, "iterations");
+    
+    return x;
+}
+
+template<typename T, typename Preconditioner>
+arma::Col<T>
+conjugate_gradient(const arma::SpMat<T>& A, const arma::Col<T>& b, T eps, size_t maxit,
+                   const Preconditioner& P)
+{
+    solver_info<T> info;
+    return conjugate_gradient(A, b, P, solver_control<T>(eps, maxit), info);
+}
 
 /* Trivial implementation of the unpreconditioned CG.
  * See "An Introduction to the Conjugate Gradient Method Without
@@ -39,30 +243,41 @@
  */
 template<typename T>
 arma::Col<T>
-conjugate_gradient(const arma::SpMat<T>& A, const arma::Col<T>& b, T eps = 1e-8, size_t maxit = 0)
+conjugate_gradient(const arma::SpMat<T>& A, const arma::Col<T>& b,
+                   const solver_control<T>& ctl, solver_info<T>& info)
 {
     assert(A.n_cols == A.n_rows);
     
-    arma::Col<T> d, r, x;
+    solver_stopwatch sw;
+    info = solver_info<T>();
+    
+    arma::Col<T> d, r, x, Ad;
     T alpha, beta;
     T res, res0;
     
-    maxit = std::max(maxit, size_t(A.n_cols));
+    T eps = ctl.eps;
+    size_t maxit = std::max(ctl.maxit, size_t(A.n_cols));
     
-    std::cout << "Starting CG. Target rr = " << eps << ", maxit = " << maxit << std::endl;
+    if (ctl.log)
+        *ctl.log << "Starting CG. Target rr = " << eps << ", maxit = " << maxit << std::endl;
     
     x.resize(b.size());
     x.zeros();
     
     r = b - A*x;
+    sw.lap(info.spmv_time);
     d = r;
     
     res = res0 = norm(r);
+    solver_record(ctl, info, 0, res/res0);
+    sw.lap(info.vector_time);
     
     size_t iter = 0;
     while ( (res/res0 > eps) and (iter++ < maxit) )
     {
-        auto Ad = A * d;
+        Ad = A * d;
+        sw.lap(info.spmv_time);
+        
         auto dot_rr = dot(r,r);
         
         alpha = dot_rr/dot(d, Ad);
@@ -72,19 +287,24 @@ conjugate_gradient(const arma::SpMat<T>& A, const arma::Col<T>& b, T eps = 1e-8,
         d = r + beta * d;
         
         res = norm(r);
+        sw.lap(info.vector_time);
+        
+        solver_record(ctl, info, iter, res/res0);
     }
     
-    if ( (iter <= maxit) and (res/res0 < eps) )
-    {
-        std::cout << "Solver converged after " << iter;
-        std::cout << " iterations, ||r||/||r0|| = " << res/res0;
-        std::cout << std::endl;
-    }
-    else
-    {
-        std::cout << "Solver NOT converged! ||r||/||r0|| = " << res/res0 << std::endl;
-    }
+    info.iterations = std::min(iter, maxit);
+    info.relative_residual = res/res0;
+    info.converged = (iter <= maxit) and (res/res0 < eps);
+    info.total_time = info.spmv_time + info.vector_time;
+    solver_log_result(ctl, info, "iterations");
     
     return x;
 }
 
+template<typename T>
+arma::Col<T>
+conjugate_gradient(const arma::SpMat<T>& A, const arma::Col<T>& b, T eps = 1e-8, size_t maxit = 0)
+{
+    solver_info<T> info;
+    return conjugate_gradient(A, b, solver_control<T>(eps, maxit), info);
+}
@@ -28,17 +28,35 @@
 
 #pragma once
 
+#include <vector>
+#include <tuple>
+#include <memory>
+#include <cassert>
 #include <armadillo>
 
+#include "gnuplot-iostream.h"
+
+#include "common.h"
+
 #include "element.hpp"
 #include "quadrature.hpp"
 #include "basis.hpp"
+#include "basis_table.hpp"
+#include "projector.hpp"
+#include "gradient_reconstruction.hpp"
 #include "stabilization.hpp"
+#include "fixed_gradient_reconstruction.hpp"
+#include "fixed_stabilization.hpp"
+#include "batched_condensation.hpp"
+#include "hho_local_operator.hpp"
+#include "local_operator_cache.hpp"
 #include "conjugate_gradient.hpp"
-
-template<typename T>
-using spmat_tuple = std::tuple<size_t, size_t, T>;
-
+#include "tridiagonal_solver.hpp"
+#include "multigrid.hpp"
+#include "face_assembler.hpp"
+#include "static_condensation.hpp"
+#include "parallel.hpp"
+#include "profiler.hpp"
 
 /****************************************************************************************
  * Example 3: diffusion
@@ -49,6 +67,8 @@ template<typename T>
 std::vector<element<T>>
 generate_mesh(size_t num_elements)
 {
+    PROFILE_SCOPE("diffusion/mesh");
+    
     std::vector<element<T>> mesh;
     mesh.reserve(num_elements);
     for (size_t i = 0; i < num_elements; i++)
@@ -60,171 +80,686 @@ generate_mesh(size_t num_elements)
     return mesh;
 }
 
-template<typename T, typename Function>
+/* Static condensation of the elements [elem_begin, elem_end) with the
+ * operators of compile-time degree K. It computes the same AC and bC as the
+ * generic code in solve_diffusion_problem, but all the local matrices have
+ * fixed size and the local solves are done by Cholesky in place. */
+template<typename T, typename Family, size_t K, typename Function>
+void
+condense_elements_fixed(const Function& pf, const std::vector<element<T>>& mesh,
+                        size_t elem_begin, size_t elem_end,
+                        arma::Mat<T>& condensed, condensation_store<T> *store)
+{
+    typedef fixed_gradient_reconstruction_operator<T, K, Family>  gr_type;
+    
+    const size_t cs = gr_type::cell_size;
+    
+    projector<T, Family>                        proj(K);
+    gr_type                                     gr;
+    fixed_stabilization_operator<T, K, Family>  stab;
+    
+    for (size_t elem_num = elem_begin; elem_num < elem_end; elem_num++)
+    {
+        auto& elem = mesh[elem_num];
+        
+        /* Compute projection on current element */
+        auto projection = proj.rhs(elem, pf);
+        
+        {
+            PROFILE_SCOPE_DETAIL("diffusion/solve/condensation/local operators");
+            gr.build(elem);
+            stab.build(elem, gr.as_matrix());
+        }
+        
+        auto& A = gr.local_contrib();
+        auto& S = stab.local_contrib();
+        
+        /* K_TT is factorized in place, and ALb = [K_TF, projection] is
+         * overwritten with [AL, bL] */
+        typename arma::Mat<T>::template fixed<cs, cs>  K_TT;
+        typename arma::Mat<T>::template fixed<cs, 3>   ALb;
+        for (size_t j = 0; j < cs; j++)
+            for (size_t i = 0; i < cs; i++)
+                K_TT(i,j) = A(i,j) + S(i,j);
+        
+        for (size_t i = 0; i < cs; i++)
+        {
+            ALb(i,0) = A(i,cs) + S(i,cs);
+            ALb(i,1) = A(i,cs+1) + S(i,cs+1);
+            ALb(i,2) = projection(i);
+        }
+        
+        fixed_cholesky_factor<cs>(K_TT.memptr());
+        fixed_cholesky_solve<cs, 3>(K_TT.memptr(), ALb.memptr());
+        
+        /* AC = K_FF - K_FT AL and bC = - K_FT bL, stored as in
+         * solve_diffusion_problem */
+        T *cd = condensed.colptr(elem_num);
+        for (size_t j = 0; j < 3; j++)
+        {
+            for (size_t i = 0; i < 2; i++)
+            {
+                T v = (j < 2) ? A(cs+i,cs+j) + S(cs+i,cs+j) : T(0);
+                for (size_t k = 0; k < cs; k++)
+                    v -= (A(cs+i,k) + S(cs+i,k)) * ALb(k,j);
+                cd[2*j+i] = v;
+            }
+        }
+        
+        if (store)
+            store->store(elem_num, ALb.colptr(0), ALb.colptr(2), gr.as_matrix().memptr());
+    }
+}
+
+/* Static condensation of the elements [elem_begin, elem_end) with compile-time
+ * degree K, by batches of consecutive elements with interleaved storage. The
+ * elements left over, fewer than a batch, are condensed one by one. The two
+ * kernels do not round in the same way, so elem_begin must be a multiple of
+ * the batch width: then each element goes to the same kernel whatever the
+ * partition of the mesh among the threads. */
+template<typename T, typename Family, size_t K, typename Function>
+void
+condense_elements_batched(const Function& pf, const std::vector<element<T>>& mesh,
+                          size_t elem_begin, size_t elem_end,
+                          arma::Mat<T>& condensed, condensation_store<T> *store)
+{
+    typedef batched_condensation<T, K, Family> batch_type;
+    
+    /* The batch is a few kB, keep it off the stack */
+    std::unique_ptr<batch_type> batch(new batch_type());
+    
+    assert(elem_begin % batch_type::width == 0);
+    
+    size_t elem_num = elem_begin;
+    for (; elem_num + batch_type::width <= elem_end; elem_num += batch_type::width)
+        batch->condense(pf, &mesh[elem_num], elem_num, condensed, store);
+    
+    condense_elements_fixed<T, Family, K>(pf, mesh, elem_num, elem_end, condensed, store);
+}
+
+/* If store is not null, the condensation data of each element is kept there
+ * for postprocess */
+template<typename T, typename Family, typename Function>
 arma::Col<T>
 solve_diffusion_problem(const run_parameters& rp, const Function& pf,
-                        const std::vector<element<T>>& mesh)
+                        const std::vector<element<T>>& mesh,
+                        condensation_store<T> *store = nullptr)
 {
+    PROFILE_SCOPE("diffusion/solve");
+    
     size_t basis_k_size     = rp.degree + 1;
     size_t dofs_num         = rp.num_elements + 3;
+    size_t num_faces        = rp.num_elements + 1;
+    bool   interior         = (rp.solver == global_solver::TRIDIAGONAL or
+                               rp.solver == global_solver::MULTIGRID);
     
-    std::vector<spmat_tuple<T>> tuples;
-    arma::Col<T> sysrhs(dofs_num);
-    sysrhs.zeros();
+    if (store)
+        store->resize(mesh.size(), basis_k_size, basis_k_size);
     
-    projector<T>                            proj(rp.degree);
-    gradient_reconstruction_operator<T>     gr(rp.degree);
-    stabilization_operator<T>               stab(rp.degree);
+    /* Condensed matrix (column-major) and rhs of each element, laid out as
+     * [AC(0,0), AC(1,0), AC(0,1), AC(1,1), bC(0), bC(1)] */
+    arma::Mat<T> condensed(6, mesh.size());
     
-    size_t elem_num = 0;
-    for (auto& elem : mesh)
+    /* The local operators of the elements are the ones of the reference
+     * element, scaled with h: they are built only once */
+    local_operator_cache<T, Family> cache;
+    if (rp.cache_operators)
     {
-        /* Compute projection on current element */
-        auto projection = proj.rhs(elem, pf);
+        PROFILE_SCOPE("diffusion/solve/operator cache");
+        cache = local_operator_cache<T, Family>(rp.degree);
+    }
+    
+    /* The elements are independent: they are split among the threads, each
+     * with its own operators, and each one writes only its own column of
+     * condensed (and of the store). */
+    auto condense = [&](size_t, size_t elem_begin, size_t elem_end) {
+        if (rp.cache_operators)
+        {
+            projector<T, Family> proj(rp.degree);
+            
+            for (size_t elem_num = elem_begin; elem_num < elem_end; elem_num++)
+            {
+                auto& elem = mesh[elem_num];
+                
+                /* Only the projection of the load depends on the element */
+                auto projection = proj.rhs(elem, pf);
+                
+                arma::Mat<T> AC;
+                arma::Col<T> bC;
+                {
+                    PROFILE_SCOPE_DETAIL("diffusion/solve/condensation/local operators");
+                    AC = cache.condensed_matrix(elem);
+                    bC = cache.condensed_rhs(projection);
+                }
+                
+                if (store)
+                    store->store(elem_num, cache.cell_elimination(),
+                                 cache.cell_solution(elem, projection), cache.gradrec());
+                
+                T *cd = condensed.colptr(elem_num);
+                std::copy(AC.begin(), AC.end(), cd);
+                cd[4] = bC(0);
+                cd[5] = bC(1);
+            }
+            
+            return;
+        }
         
-        gr.build(elem);
-        stab.build(elem, gr.as_matrix());
+        /* Otherwise the operators are rebuilt on each element. Low degrees
+         * use the operators with compile-time degree, on batches of
+         * elements. */
+        bool fixed = dispatch_fixed_degree(rp.degree, [&](auto degree) {
+            condense_elements_batched<T, Family, decltype(degree)::value>(pf, mesh,
+                elem_begin, elem_end, condensed, store);
+        });
         
-        arma::Mat<T> A = gr.local_contrib();
-        arma::Mat<T> S = stab.local_contrib();
+        if (fixed)
+            return;
         
-        arma::Mat<T> LC = A + S;
+        projector<T, Family>            proj(rp.degree);
+        hho_local_operator<T, Family>   lop(rp.degree);
         
-        arma::Mat<T> K_TT = LC.submat(0, 0, arma::size(basis_k_size, basis_k_size));
-        arma::Mat<T> K_TF = LC.submat(0, basis_k_size, arma::size(basis_k_size, 2));
-        arma::Mat<T> K_FT = LC.submat(basis_k_size, 0, arma::size(2, basis_k_size));
-        arma::Mat<T> K_FF = LC.submat(basis_k_size, basis_k_size, arma::size(2, 2));
+        for (size_t elem_num = elem_begin; elem_num < elem_end; elem_num++)
+        {
+            auto& elem = mesh[elem_num];
+            
+            /* Compute projection on current element */
+            auto projection = proj.rhs(elem, pf);
+            
+            {
+                PROFILE_SCOPE_DETAIL("diffusion/solve/condensation/local operators");
+                lop.build(elem);
+            }
+            
+            const arma::Mat<T>& LC = lop.local_contrib();
+            
+            arma::Mat<T> K_TT = LC.submat(0, 0, arma::size(basis_k_size, basis_k_size));
+            arma::Mat<T> K_TF = LC.submat(0, basis_k_size, arma::size(basis_k_size, 2));
+            arma::Mat<T> K_FT = LC.submat(basis_k_size, 0, arma::size(2, basis_k_size));
+            arma::Mat<T> K_FF = LC.submat(basis_k_size, basis_k_size, arma::size(2, 2));
+            
+            /* K_TT is factorized once for both the solves */
+            spd_solver<T> K_TT_solver(K_TT);
+            arma::Mat<T> AL = K_TT_solver.solve(K_TF);
+            arma::Col<T> bL = K_TT_solver.solve(projection);
+            
+            arma::Mat<T> AC = K_FF - K_FT * AL;
+            arma::Col<T> bC = /* explain this */ - K_FT * bL;
+            
+            if (store)
+                store->store(elem_num, AL, bL, lop.gradrec());
+            
+            T *cd = condensed.colptr(elem_num);
+            std::copy(AC.begin(), AC.end(), cd);
+            cd[4] = bC(0);
+            cd[5] = bC(1);
+        }
+    };
+    
+    {
+        PROFILE_SCOPE("diffusion/solve/condensation");
+        /* The chunks are aligned to the batches of condense_elements_batched */
+        parallel_for_chunks(mesh.size(), rp.num_threads, condense,
+                            simd_batch_width<T>::value);
+    }
+    
+    /* The element contributions are then merged serially into the global
+     * system: it is cheap and it does not need any synchronization */
+    arma::Mat<T> AC(2,2);
+    arma::Col<T> bC(2);
+    auto unpack = [&](size_t elem_num) {
+        const T *cd = condensed.colptr(elem_num);
+        std::copy(cd, cd+4, AC.begin());
+        bC(0) = cd[4];
+        bC(1) = cd[5];
+    };
+    
+    if (interior)
+    {
+        /* Diagonals and rhs of the system on the interior faces, used by the
+         * tridiagonal and the multigrid solvers. Interior face f is unknown
+         * f-1. */
+        arma::Col<T> tlower, tdiag, tupper, trhs;
+        tlower.zeros(num_faces-2);
+        tdiag.zeros(num_faces-2);
+        tupper.zeros(num_faces-2);
+        trhs.zeros(num_faces-2);
+        
+        {
+            PROFILE_SCOPE("diffusion/solve/assembly");
+            for (size_t elem_num = 0; elem_num < mesh.size(); elem_num++)
+            {
+                unpack(elem_num);
+                add_to_interior_system(elem_num, num_faces, AC, tlower, tdiag, tupper);
+                for (size_t i = 0; i < AC.n_rows; i++)
+                {
+                    size_t fi = elem_num+i;
+                    if (fi != 0 and fi != num_faces-1)
+                        trhs(fi-1) += bC(i);
+                }
+            }
+        }
         
-        arma::Mat<T> AL = solve(K_TT, K_TF);
-        arma::Col<T> bL = solve(K_TT, projection);
+        arma::Col<T> x(num_faces);
+        x.zeros();
+        if (num_faces <= 2)
+            return x;
         
-        arma::Mat<T> AC = K_FF - K_FT * AL;
-        arma::Col<T> bC = /* explain this */ - K_FT * bL;
+        if (rp.solver == global_solver::TRIDIAGONAL)
+        {
+            PROFILE_SCOPE("diffusion/solve/global solver");
+            x.subvec(1, num_faces-2) = tridiagonal_solve(tlower, tdiag, tupper, trhs);
+            return x;
+        }
         
-        for (size_t i = 0; i < AC.n_rows; i++)
+        /* Multigrid: the coarse levels are the same face system, assembled
+         * on meshes with half the elements each time */
+        face_multigrid<T> mg(mesh.front().points()[0], mesh.back().points()[1],
+                             rp.mg_cycle, rp.mg_smoother);
         {
-            for (size_t j = 0; j < AC.n_cols; j++)
-                tuples.push_back( std::make_tuple(elem_num+i, elem_num+j, AC(i,j)) );
-            sysrhs(elem_num+i) += bC(i);
+            PROFILE_SCOPE("diffusion/solve/multigrid levels");
+            mg.add_level(tlower, tdiag, tupper, interior_faces(mesh));
+            
+            std::vector<element<T>> level_mesh = coarsen_mesh(mesh);
+            while (level_mesh.size() >= 2)
+            {
+                arma::Col<T> lower, diag, upper;
+                assemble_interior_system<T, Family>(rp, level_mesh, cache, lower, diag, upper);
+                mg.add_level(lower, diag, upper, interior_faces(level_mesh));
+                
+                if (level_mesh.size() == 2)
+                    break;
+                
+                level_mesh = coarsen_mesh(level_mesh);
+            }
         }
         
-        elem_num++;
+        PROFILE_SCOPE("diffusion/solve/global solver");
+        solver_control<T> ctl(1e-9);
+        ctl.log = rp.quiet ? nullptr : &std::cout;
+        solver_info<T> info;
+        x.subvec(1, num_faces-2) = mg.solve(trhs, ctl, info);
+        PROFILE_COUNT("diffusion/solve/global solver/iterations", info.iterations);
+        return x;
     }
     
-    tuples.push_back( std::make_tuple(0, dofs_num-2, 1) );
-    tuples.push_back( std::make_tuple(dofs_num-3, dofs_num-1, 1) );
-    tuples.push_back( std::make_tuple(dofs_num-2, 0, 1) );
-    tuples.push_back( std::make_tuple(dofs_num-1, dofs_num-3, 1) );
+    /* Otherwise the full system with the multipliers is assembled in place
+     * in its final sparse storage */
+    face_system_assembler<T> assembler(rp.num_elements);
+    arma::Col<T> sysrhs(dofs_num);
+    sysrhs.zeros();
+    {
+        PROFILE_SCOPE("diffusion/solve/assembly");
+        for (size_t elem_num = 0; elem_num < mesh.size(); elem_num++)
+        {
+            unpack(elem_num);
+            assembler.add(elem_num, AC);
+            for (size_t i = 0; i < AC.n_rows; i++)
+                sysrhs(elem_num+i) += bC(i);
+        }
+    }
     
-    arma::umat      locations(2, tuples.size());
-    arma::Col<T>    values(tuples.size());
+    if (rp.solver == global_solver::PCG)
+    {
+        /* SPD system on the faces, with the Dirichlet faces eliminated */
+        arma::SpMat<T> sysmat;
+        {
+            PROFILE_SCOPE("diffusion/solve/sparse matrix");
+            sysmat = assembler.dirichlet_matrix();
+        }
+        arma::Col<T> rhs = sysrhs.head(num_faces);
+        rhs(0) = 0;
+        rhs(num_faces-1) = 0;
+        
+        PROFILE_SCOPE("diffusion/solve/global solver");
+        solver_control<T> ctl(1e-9, 2*sysmat.n_cols);
+        ctl.log = rp.quiet ? nullptr : &std::cout;
+        solver_info<T> info;
+        
+        arma::Col<T> x;
+        switch (rp.preconditioner)
+        {
+            case preconditioner_type::JACOBI:
+                x = conjugate_gradient(sysmat, rhs,
+                                       jacobi_preconditioner<T>(sysmat), ctl, info);
+                break;
+            
+            case preconditioner_type::SSOR:
+                x = conjugate_gradient(sysmat, rhs,
+                                       ssor_preconditioner<T>(sysmat), ctl, info);
+                break;
+            
+            case preconditioner_type::INCOMPLETE_CHOLESKY:
+                x = conjugate_gradient(sysmat, rhs,
+                                       incomplete_cholesky_preconditioner<T>(sysmat), ctl, info);
+                break;
+            
+            default:
+                x = fused_conjugate_gradient(sysmat, rhs, ctl, info);
+        }
+        
+        PROFILE_COUNT("diffusion/solve/global solver/iterations", info.iterations);
+        return x;
+    }
     
-    for (size_t i = 0; i < tuples.size(); i++)
+    arma::SpMat<T> sysmat;
     {
-        locations(0,i) = std::get<0>(tuples[i]);
-        locations(1,i) = std::get<1>(tuples[i]);
-        values(i) = std::get<2>(tuples[i]);
+        PROFILE_SCOPE("diffusion/solve/sparse matrix");
+        sysmat = assembler.matrix();
     }
     
-    arma::SpMat<T>  sysmat(true, locations, values, dofs_num, dofs_num);
+    PROFILE_SCOPE("diffusion/solve/global solver");
+    solver_control<T> ctl(1e-9, 2*sysmat.n_cols);
+    ctl.log = rp.quiet ? nullptr : &std::cout;
+    solver_info<T> info;
     
     // CG is definitely not the right solver because of the way the boundary
     // conditions are imposed. However it appears to work, so we keep it for
     // now.
-    return conjugate_gradient(sysmat, sysrhs, 1e-9, 2*sysmat.n_cols);
+    arma::Col<T> x = fused_conjugate_gradient(sysmat, sysrhs, ctl, info);
+    PROFILE_COUNT("diffusion/solve/global solver/iterations", info.iterations);
+    return x;
 }
 
 
-template<typename T, typename Function, typename AnalyticSolution>
+/* If store is not null it must have been filled by solve_diffusion_problem,
+ * and the cell unknowns are recovered from it */
+template<typename T, typename Family, typename Function, typename AnalyticSolution>
 std::tuple<arma::Col<T>, arma::Col<T>, T, T>
 postprocess(const run_parameters& rp, const arma::Col<T>& x,
             const Function& pf, const AnalyticSolution& sf,
-            const std::vector<element<T>>& mesh)
+            const std::vector<element<T>>& mesh,
+            const condensation_store<T> *store = nullptr)
 {
+    PROFILE_SCOPE("diffusion/postprocess");
+    
     size_t basis_k_size     = rp.degree + 1;
     
     arma::Col<T> x_val(rp.num_elements * rp.eval_per_elem);
     arma::Col<T> pot_val(rp.num_elements * rp.eval_per_elem);
     
-    projector<T>                            proj(rp.degree);
-    gradient_reconstruction_operator<T>     gr(rp.degree);
-    stabilization_operator<T>               stab(rp.degree);
-    quadrature<T>                           quad(2*rp.degree);
-    basis<T>                                basis(rp.degree);
-    size_t pos = 0;
-    size_t elem_num = 0;
+    /* Shared, read-only among the threads */
+    quadrature<T>                               quad(2*rp.degree);
+    basis<T, Family>                            basis(rp.degree);
+    basis_table<T, Family>                      table(basis, quad);
+    
+    /* Squared error of each element, summed at the end */
+    arma::Col<T> elem_l2_err(mesh.size());
+    arma::Col<T> elem_l2_err_func(mesh.size());
+    
+    /* Each thread has its own operators and writes only the entries of the
+     * elements it owns: the test points of element e start at position
+     * e * eval_per_elem. */
+    auto process = [&](size_t, size_t elem_begin, size_t elem_end) {
+        projector<T, Family>                        proj(rp.degree);
+        gradient_reconstruction_operator<T, Family> gr(rp.degree);
+        stabilization_operator<T, Family>           stab(rp.degree);
+        
+        for (size_t elem_num = elem_begin; elem_num < elem_end; elem_num++)
+        {
+            auto& elem = mesh[elem_num];
+            
+            arma::Col<T> solF(2);
+            solF(0) = x(elem_num);
+            solF(1) = x(elem_num+1);
+            
+            /* Compute some test points inside the element */
+            auto tps = make_test_points(elem, rp.eval_per_elem);
+            
+            arma::Col<T> solT, pots;
+            if (store)
+            {
+                solT = store->cell_unknowns(elem_num, solF);
+                
+                /* Postprocess: recover the solution on the test points */
+                reconstruction_evaluator<T, Family> rec(elem, solT(0),
+                                                        store->reconstruction(elem_num, solF));
+                pots = rec.potential(tps);
+            }
+            else
+            {
+                gr.build(elem);
+                stab.build(elem, gr.as_matrix());
+                
+                arma::Mat<T> A = gr.local_contrib();
+                arma::Mat<T> S = stab.local_contrib();
+                
+                arma::Mat<T> LC = A + S;
+                
+                arma::Mat<T> K_TT = LC.submat(0, 0, arma::size(basis_k_size, basis_k_size));
+                arma::Mat<T> K_TF = LC.submat(0, basis_k_size, arma::size(basis_k_size, 2));
+                
+                arma::Col<T> rhs_c = proj.rhs(elem, pf);
+                solT = spd_solver<T>(K_TT).solve(rhs_c - K_TF*solF);
+                
+                arma::Col<T> sol(basis_k_size+2);
+                sol.head(basis_k_size) = solT;
+                sol.tail(2) = solF;
+                
+                //std::cout << (gr.as_matrix() * sol).t() << std::endl;
+                
+                /* Postprocess: recover the solution on the test points */
+                pots = gr.reconstruction(elem, sol).potential(tps);
+            }
+            
+            size_t pos = elem_num * rp.eval_per_elem;
+            for (size_t j = 0; j < rp.eval_per_elem; j++)
+            {
+                x_val(pos) = tps[j];
+                pot_val(pos) = pots(j);
+                pos++;
+            }
+            
+            arma::Col<T> asolT = proj.project(elem, sf);
+            arma::Mat<T> mass = proj.as_matrix(elem);
+            
+            arma::Mat<T> me = mass.submat(0, 0, arma::size(basis_k_size, basis_k_size));
+            arma::Col<T> ve_t = (asolT - solT);
+            arma::Col<T> ve = ve_t.head(basis_k_size);
+            
+            elem_l2_err(elem_num) = dot( ve, me * ve );
+            
+            /* Values of the cell solution at all the nodes at once */
+            arma::Col<T> rvals = table.function_matrix() * solT;
+            
+            T err_func = 0.;
+            size_t iqp = 0;
+            for (auto qp : quad.map(elem))
+            {
+                auto qpoint  = qp.first;
+                auto qweight = qp.second;
+                
+                auto fval = sf(qpoint);
+                auto rval = rvals(iqp++);
+                
+                err_func += (rval-fval) * (rval-fval) * qweight;
+            }
+            elem_l2_err_func(elem_num) = err_func;
+        }
+    };
+    
+    parallel_for_chunks(mesh.size(), rp.num_threads, process);
+    
+    /* Sum the element errors always in mesh order, so that the result does
+     * not depend on the number of threads. This needs the element errors
+     * themselves not to depend on it, which holds as long as x and store
+     * do not: solve_diffusion_problem ensures it by aligning its chunks to
+     * the batches of the condensation. */
     T l2_err = 0.;
     T l2_err_func = 0.;
-    for (auto& elem : mesh)
+    for (size_t elem_num = 0; elem_num < mesh.size(); elem_num++)
     {
-        arma::Col<T> solF(2);
-        solF(0) = x(elem_num);
-        solF(1) = x(elem_num+1);
-        
-        gr.build(elem);
-        stab.build(elem, gr.as_matrix());
+        l2_err += elem_l2_err(elem_num);
+        l2_err_func += elem_l2_err_func(elem_num);
+    }
+    
+    return std::make_tuple(x_val, pot_val, sqrt(l2_err), sqrt(l2_err_func));
+}
+
+/* Streaming solver for a uniform mesh of rp.num_elements elements. The
+ * condensed face system is tridiagonal and element e only touches the rows of
+ * faces e and e+1, so the row of face e is complete as soon as element e is
+ * condensed. A first pass over the elements, generated on the fly, condenses
+ * each one and immediately does the forward elimination of the Thomas
+ * algorithm on the row just completed. A second pass, backwards, does the
+ * back substitution: when it reaches element e both its face unknowns are
+ * known, so the cell unknowns are recovered and the errors accumulated right
+ * away. The only storage is the modified upper diagonal c and right hand
+ * side d of the interior faces.
+ *
+ * Nothing per element is kept between the passes, this is the trade-off of
+ * the O(faces) memory: the backward pass recomputes what it needs. With the
+ * operator cache it is only the projection of the load and one solve with
+ * the factor of K_TT, for bL; AL is the same on every element. With -r the
+ * local operator is rebuilt in both passes, so the element work doubles
+ * compared with -s tridiag.
+ *
+ * It returns the same errors as postprocess. The passes are serial. */
+template<typename T, typename Family, typename Function, typename AnalyticSolution>
+std::pair<T, T>
+solve_diffusion_streaming(const run_parameters& rp, const Function& pf,
+                          const AnalyticSolution& sf)
+{
+    PROFILE_SCOPE("diffusion/stream");
+    
+    size_t num_elements     = rp.num_elements;
+    size_t basis_k_size     = rp.degree + 1;
+    size_t num_interior     = (num_elements > 1) ? num_elements-1 : 0;
+    
+    /* Interior face f is row f-1 */
+    arma::Col<T> c(num_interior), d(num_interior);
+    
+    if (not rp.quiet)
+        std::cout << "Streaming solver: " << num_interior << " interior faces, "
+                  << 2*num_interior*sizeof(T)/(1024.*1024.) << " MB" << std::endl;
+    
+    local_operator_cache<T, Family> cache;
+    hho_local_operator<T, Family>   lop;
+    if (rp.cache_operators)
+        cache = local_operator_cache<T, Family>(rp.degree);
+    else
+        lop = hho_local_operator<T, Family>(rp.degree);
+    
+    projector<T, Family>    proj(rp.degree);
+    
+    /* AC, bC, AL and bL of an element, as in solve_diffusion_problem. With
+     * the cache, the forward pass only needs AC and bC and the backward pass
+     * only bL. */
+    arma::Mat<T> AC, AL;
+    arma::Col<T> bC, bL;
+    if (rp.cache_operators)
+        AL = cache.cell_elimination();
+    
+    auto condense = [&](const element<T>& elem, bool forward) {
+        arma::Col<T> f_T = proj.rhs(elem, pf);
         
-        arma::Mat<T> A = gr.local_contrib();
-        arma::Mat<T> S = stab.local_contrib();
+        if (rp.cache_operators)
+        {
+            if (forward)
+            {
+                AC = cache.condensed_matrix(elem);
+                bC = cache.condensed_rhs(f_T);
+            }
+            else
+                bL = cache.cell_solution(elem, f_T);
+            return;
+        }
         
-        arma::Mat<T> LC = A + S;
+        lop.build(elem);
+        const arma::Mat<T>& LC = lop.local_contrib();
         
         arma::Mat<T> K_TT = LC.submat(0, 0, arma::size(basis_k_size, basis_k_size));
         arma::Mat<T> K_TF = LC.submat(0, basis_k_size, arma::size(basis_k_size, 2));
+        arma::Mat<T> K_FT = LC.submat(basis_k_size, 0, arma::size(2, basis_k_size));
+        arma::Mat<T> K_FF = LC.submat(basis_k_size, basis_k_size, arma::size(2, 2));
         
-        arma::Col<T> rhs_c = proj.rhs(elem, pf);
-        arma::Col<T> solT = solve(K_TT, rhs_c - K_TF*solF);
-        
-        arma::Col<T> sol(basis_k_size+2);
-        sol.head(basis_k_size) = solT;
-        sol.tail(2) = solF;
-        
-        //std::cout << (gr.as_matrix() * sol).t() << std::endl;
-        
-        /* Compute some test points inside the element */
-        auto tps = make_test_points(elem, rp.eval_per_elem);
+        spd_solver<T> K_TT_solver(K_TT);
+        AL = K_TT_solver.solve(K_TF);
+        bL = K_TT_solver.solve(f_T);
+        AC = K_FF - K_FT * AL;
+        bC = - K_FT * bL;
+    };
+    
+    auto make_element = [&](size_t elem_num) {
+        return element<T>(T(elem_num)/num_elements, T(elem_num+1)/num_elements);
+    };
+    
+    /* Forward pass. The pending row is the one of face elem_num, with the
+     * contribution of the previous element; the Dirichlet faces are
+     * eliminated, so their couplings are dropped. */
+    {
+        PROFILE_SCOPE("diffusion/stream/forward");
         
-        /* Postprocess: recover the solution on the test points */
-        for (size_t j = 0; j < rp.eval_per_elem; j++)
+        T lower = 0., diag = 0., rhs = 0.;
+        for (size_t elem_num = 0; elem_num < num_elements; elem_num++)
         {
-            x_val(pos) = tps[j];
-            pot_val(pos) = gr.reconstruct_potential(elem, sol, tps[j]);
-            pos++;
+            condense(make_element(elem_num), true);
+            
+            if (elem_num > 0)
+            {
+                size_t row = elem_num-1;
+                T upper = (elem_num+1 < num_elements) ? AC(0,1) : T(0);
+                diag += AC(0,0);
+                rhs += bC(0);
+                
+                T c_prev = (row > 0) ? c(row-1) : T(0);
+                T d_prev = (row > 0) ? d(row-1) : T(0);
+                T m = diag - lower*c_prev;
+                c(row) = upper/m;
+                d(row) = (rhs - lower*d_prev)/m;
+            }
+            
+            if (elem_num+1 < num_elements)
+            {
+                lower = (elem_num > 0) ? AC(1,0) : T(0);
+                diag = AC(1,1);
+                rhs = bC(1);
+            }
         }
+    }
+    
+    /* Backward pass, fused with the recovery of the cell unknowns and with
+     * the errors of postprocess */
+    PROFILE_SCOPE("diffusion/stream/backward");
+    
+    quadrature<T>           quad(2*rp.degree);
+    basis<T, Family>        basis(rp.degree);
+    basis_table<T, Family>  table(basis, quad);
+    
+    T l2_err = 0.;
+    T l2_err_func = 0.;
+    arma::Col<T> solF(2);
+    solF(1) = 0.;
+    for (size_t elem_num = num_elements; elem_num-- > 0; )
+    {
+        auto elem = make_element(elem_num);
         
-        arma::Col<T> asolT = proj.project(elem, sf);
-        arma::Mat<T> mass = proj.as_matrix(elem);
+        solF(0) = (elem_num > 0) ? d(elem_num-1) - c(elem_num-1)*solF(1) : T(0);
         
-        arma::Mat<T> me = mass.submat(0, 0, arma::size(basis_k_size, basis_k_size));
-        arma::Col<T> ve_t = (asolT - solT);
-        arma::Col<T> ve = ve_t.head(basis_k_size);
+        condense(elem, false);
+        arma::Col<T> solT = bL - AL*solF;
         
-        l2_err += dot( ve, me * ve );
+        arma::Col<T> ve = proj.project(elem, sf) - solT;
+        l2_err += dot( ve, proj.as_matrix(elem) * ve );
         
+        arma::Col<T> rvals = table.function_matrix() * solT;
         
-        auto qd = quad.integrate(elem);
-        for (auto& qp : qd)
+        size_t iqp = 0;
+        for (auto qp : quad.map(elem))
         {
-            auto qpoint  = qp.first;
-            auto qweight = qp.second;
-            
-            auto fval = sf(qpoint);
+            auto fval = sf(qp.first);
+            auto rval = rvals(iqp++);
             
-            T rval = 0.;
-            auto phi = basis.eval_functions(elem, qpoint);
-            for (size_t i = 0; i < phi.size(); i++)
-                rval += phi[i] * solT(i);
-            
-            l2_err_func += (rval-fval) * (rval-fval) * qweight;
+            l2_err_func += (rval-fval) * (rval-fval) * qp.second;
         }
         
-        elem_num++;
+        solF(1) = solF(0);
     }
     
-    return std::make_tuple(x_val, pot_val, sqrt(l2_err), sqrt(l2_err_func));
+    return std::make_pair(sqrt(l2_err), sqrt(l2_err_func));
 }
 
-template<typename T>
+template<typename T, typename Family = scaled_monomials>
 int
 run_example_diffusion(const run_parameters& rp)
 {
@@ -235,12 +770,36 @@ run_example_diffusion(const run_parameters& rp)
     auto sf = [](T x) -> T {
         return sin(3.141592*x);
     };
- 
-    /* Generate mesh */
-    auto mesh = generate_mesh<T>(rp.num_elements);
     
-    auto x = solve_diffusion_problem(rp, pf, mesh);
-    auto pp = postprocess(rp, x, pf, sf, mesh);
+    if (rp.solver == global_solver::STREAMING)
+    {
+        auto err = solve_diffusion_streaming<T, Family>(rp, pf, sf);
+        
+        std::cout << "Err (with dofs) = " << err.first << std::endl;
+        std::cout << "Err (with func) = " << err.second << std::endl;
+        std::cout << "Difference      = " << err.first - err.second << std::endl;
+        
+        if (rp.draw)
+            std::cout << "The streaming solver does not keep the solution: nothing to draw." << std::endl;
+        
+        return 0;
+    }
+    
+    std::vector<element<T>> mesh;
+    arma::Col<T> x;
+    std::tuple<arma::Col<T>, arma::Col<T>, T, T> pp;
+    {
+        PROFILE_SCOPE("diffusion");
+        
+        /* Generate mesh */
+        mesh = generate_mesh<T>(rp.num_elements);
+        
+        /* Keep the condensation data, so that postprocess does not redo it */
+        condensation_store<T> store;
+        
+        x = solve_diffusion_problem<T, Family>(rp, pf, mesh, &store);
+        pp = postprocess<T, Family>(rp, x, pf, sf, mesh, &store);
+    }
     
     std::cout << "Err (with dofs) = " << std::get<2>(pp) << std::endl;
     std::cout << "Err (with func) = " << std::get<3>(pp) << std::endl;
@@ -29,6 +29,7 @@
 #pragma once
 
 #include <array>
+#include <vector>
 
 template<typename T>
 class element
@@ -0,0 +1,173 @@
+/*
+ *       /\
+ *      /__\        Matteo Cicuttin (C) 2016 - matteo.cicuttin@enpc.fr
+ *     /_\/_\
+ *    /\    /\      École Nationale des Ponts et Chaussées
+ *   /__\  /__\     CERMICS
+ *  /_\/_\/_\/_\
+ *
+ * This is a simple 1D code for the demonstration of the Hybrid High Order
+ * numerical method. It is intended only to show the details of all the
+ * involved operators (projection, gradient reconstruction, stabilization)
+ * step by step.
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <armadillo>
+#include <cassert>
+
+/* Assembler for the statically condensed face system of the diffusion
+ * problem. Each element couples only its two faces, and the two Dirichlet
+ * conditions are imposed with two Lagrange multipliers, so the sparsity
+ * pattern is known from the number of elements alone. The compressed sparse
+ * column structure (the storage used by arma::SpMat) is therefore built once
+ * in the constructor and the element contributions are summed in place, with
+ * no intermediate list of triplets and no sorting.
+ *
+ * Unknowns 0..N are the faces, N+1 and N+2 the multipliers of the first and
+ * of the last face.
+ */
+template<typename T>
+class face_system_assembler
+{
+    size_t          m_num_faces;
+    arma::uvec      m_row_indices;
+    arma::uvec      m_col_ptrs;
+    arma::Col<T>    m_values;
+    
+    /* Position in m_values of the face-face entry (row, col). In face column
+     * col the face rows col-1, col and col+1 come first, in this order. */
+    size_t
+    position(size_t row, size_t col) const
+    {
+        size_t first_row = (col == 0) ? 0 : col-1;
+        assert(row >= first_row and row <= col+1 and row < m_num_faces);
+        return m_col_ptrs(col) + row - first_row;
+    }
+    
+public:
+    face_system_assembler(size_t num_elements)
+        : m_num_faces(num_elements+1)
+    {
+        assert(num_elements > 0);
+        
+        size_t num_dofs = m_num_faces + 2;
+        size_t nnz = 3*m_num_faces - 2 + 4;
+        
+        m_row_indices.set_size(nnz);
+        m_col_ptrs.set_size(num_dofs+1);
+        m_values.zeros(nnz);
+        
+        size_t pos = 0;
+        for (size_t col = 0; col < m_num_faces; col++)
+        {
+            m_col_ptrs(col) = pos;
+            
+            if (col > 0)
+                m_row_indices(pos++) = col-1;
+            m_row_indices(pos++) = col;
+            if (col < m_num_faces-1)
+                m_row_indices(pos++) = col+1;
+            
+            /* Multiplier rows come last, they have the largest indices */
+            if (col == 0)
+            {
+                m_values(pos) = 1;
+                m_row_indices(pos++) = m_num_faces;
+            }
+            if (col == m_num_faces-1)
+            {
+                m_values(pos) = 1;
+                m_row_indices(pos++) = m_num_faces+1;
+            }
+        }
+        
+        m_col_ptrs(m_num_faces) = pos;
+        m_values(pos) = 1;
+        m_row_indices(pos++) = 0;
+        
+        m_col_ptrs(m_num_faces+1) = pos;
+        m_values(pos) = 1;
+        m_row_indices(pos++) = m_num_faces-1;
+        
+        m_col_ptrs(m_num_faces+2) = pos;
+        assert(pos == nnz);
+    }
+    
+    /* Sum the 2x2 condensed matrix of element elem_num, which couples faces
+     * elem_num and elem_num+1 */
+    void
+    add(size_t elem_num, const arma::Mat<T>& AC)
+    {
+        for (size_t j = 0; j < 2; j++)
+            for (size_t i = 0; i < 2; i++)
+                m_values( position(elem_num+i, elem_num+j) ) += AC(i,j);
+    }
+    
+    size_t num_dofs() const
+    {
+        return m_num_faces + 2;
+    }
+    
+    arma::SpMat<T>
+    matrix() const
+    {
+        return arma::SpMat<T>(m_row_indices, m_col_ptrs, m_values,
+                              num_dofs(), num_dofs());
+    }
+    
+    /* The face block alone, with the homogeneous Dirichlet conditions imposed
+     * by elimination instead of with the multipliers: the rows and columns of
+     * the two boundary faces are replaced by the identity. The matrix is SPD,
+     * so it can be used with the preconditioned CG. The rhs entries of the
+     * boundary faces must be set to zero. */
+    arma::SpMat<T>
+    dirichlet_matrix() const
+    {
+        size_t nnz = 3*m_num_faces - 2;
+        size_t last = m_num_faces-1;
+        
+        arma::uvec      row_indices(nnz), col_ptrs(m_num_faces+1);
+        arma::Col<T>    values(nnz);
+        
+        size_t pos = 0;
+        for (size_t col = 0; col < m_num_faces; col++)
+        {
+            col_ptrs(col) = pos;
+            
+            size_t first_row = (col == 0) ? 0 : col-1;
+            size_t last_row = (col == last) ? col : col+1;
+            for (size_t row = first_row; row <= last_row; row++)
+            {
+                bool boundary = (row == 0 or row == last or col == 0 or col == last);
+                
+                row_indices(pos) = row;
+                if (boundary)
+                    values(pos) = (row == col) ? 1 : 0;
+                else
+                    values(pos) = m_values( position(row, col) );
+                pos++;
+            }
+        }
+        
+        col_ptrs(m_num_faces) = pos;
+        assert(pos == nnz);
+        
+        return arma::SpMat<T>(row_indices, col_ptrs, values, m_num_faces, m_num_faces);
+    }
+};
@@ -0,0 +1,60 @@
+/*
+ *       /\
+ *      /__\        Matteo Cicuttin (C) 2016 - matteo.cicuttin@enpc.fr
+ *     /_\/_\
+ *    /\    /\      École Nationale des Ponts et Chaussées
+ *   /__\  /__\     CERMICS
+ *  /_\/_\/_\/_\
+ *
+ * This is a simple 1D code for the demonstration of the Hybrid High Order
+ * numerical method. It is intended only to show the details of all the
+ * involved operators (projection, gradient reconstruction, stabilization)
+ * step by step.
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <type_traits>
+
+/* Operators for degrees up to max_fixed_degree have a version where the degree
+ * is a template parameter, so that all their matrices have compile-time size.
+ * dispatch_fixed_degree() maps the runtime degree to one of them: it calls
+ * fn(std::integral_constant<size_t, K>()) with K == degree and returns true,
+ * or it returns false if the degree is too high and the generic operators
+ * have to be used.
+ */
+static const size_t max_fixed_degree = 6;
+
+template<size_t K, typename Function>
+typename std::enable_if<(K > max_fixed_degree), bool>::type
+dispatch_fixed_degree(size_t, const Function&)
+{
+    return false;
+}
+
+template<size_t K = 0, typename Function>
+typename std::enable_if<(K <= max_fixed_degree), bool>::type
+dispatch_fixed_degree(size_t degree, const Function& fn)
+{
+    if (degree == K)
+    {
+        fn(std::integral_constant<size_t, K>());
+        return true;
+    }
+    
+    return dispatch_fixed_degree<K+1>(degree, fn);
+}
@@ -0,0 +1,132 @@
+/*
+ *       /\
+ *      /__\        Matteo Cicuttin (C) 2016 - matteo.cicuttin@enpc.fr
+ *     /_\/_\
+ *    /\    /\      École Nationale des Ponts et Chaussées
+ *   /__\  /__\     CERMICS
+ *  /_\/_\/_\/_\
+ *
+ * This is a simple 1D code for the demonstration of the Hybrid High Order
+ * numerical method. It is intended only to show the details of all the
+ * involved operators (projection, gradient reconstruction, stabilization)
+ * step by step.
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <armadillo>
+
+#include "element.hpp"
+#include "basis.hpp"
+#include "basis_table.hpp"
+#include "moment_table.hpp"
+#include "fixed_degree.hpp"
+#include "local_solver.hpp"
+
+/* Gradient reconstruction of compile-time degree K. It computes the same
+ * operator as gradient_reconstruction_operator, but all the matrices have
+ * fixed size, so build() does no heap allocation and the loops have
+ * compile-time bounds.
+ */
+template<typename T, size_t K, typename Family = scaled_monomials>
+class fixed_gradient_reconstruction_operator
+{
+public:
+    static const size_t cell_size   = K+1;  /* cell unknowns */
+    static const size_t dofs_size   = K+3;  /* cell and face unknowns */
+    static const size_t rec_size    = K+1;  /* reconstruction, without the constant */
+    
+    typedef typename arma::Mat<T>::template fixed<rec_size, dofs_size>    gradrec_matrix_type;
+    typedef typename arma::Mat<T>::template fixed<dofs_size, dofs_size>   local_matrix_type;
+    
+private:
+    gradrec_matrix_type     gradrec_matrix;
+    local_matrix_type       local_contrib_matrix;
+    basis<T, Family>        m_basis;
+    basis_table<T, Family>  m_table;
+    moment_table<T, Family> m_moments;
+    
+    void
+    build_matrices(const element<T>& elem)
+    {
+        /* MG is the stiffness of the non-constant functions, BG is the right
+         * hand side of the reconstruction */
+        typename arma::Mat<T>::template fixed<rec_size, rec_size> MG;
+        gradrec_matrix_type BG;
+        
+        auto h = elem.measure();
+        auto& K_ref = m_moments.reference_stiffness();
+        
+        for (size_t j = 0; j < rec_size; j++)
+            for (size_t i = 0; i < rec_size; i++)
+                MG(i,j) = K_ref(i+1,j+1) / h;
+        
+        for (size_t j = 0; j < cell_size; j++)
+            for (size_t i = 0; i < rec_size; i++)
+                BG(i,j) = K_ref(i+1,j) / h;
+        
+        /* Face gradients in the table are not scaled by 1/h */
+        auto& phiF1 = m_table.face_functions(0);
+        auto& dphiF1 = m_table.face_gradients(0);
+        auto& phiF2 = m_table.face_functions(1);
+        auto& dphiF2 = m_table.face_gradients(1);
+        
+        /* Beware of the signs: they are due to the normals */
+        for (size_t i = 0; i < rec_size; i++)
+        {
+            for (size_t j = 0; j < cell_size; j++)
+                BG(i,j) += (dphiF1(i+1) * phiF1(j) - dphiF2(i+1) * phiF2(j)) / h;
+            
+            BG(i,cell_size)     = - dphiF1(i+1) / h;
+            BG(i,cell_size+1)   = + dphiF2(i+1) / h;
+        }
+        
+        /* Solve MG R = BG in place */
+        gradrec_matrix = BG;
+        fixed_cholesky_factor<rec_size>(MG.memptr());
+        fixed_cholesky_solve<rec_size, dofs_size>(MG.memptr(), gradrec_matrix.memptr());
+        
+        local_contrib_matrix.zeros();
+        for (size_t j = 0; j < dofs_size; j++)
+            for (size_t i = 0; i < dofs_size; i++)
+                for (size_t k = 0; k < rec_size; k++)
+                    local_contrib_matrix(i,j) += BG(k,i) * gradrec_matrix(k,j);
+    }
+    
+public:
+    fixed_gradient_reconstruction_operator()
+        : m_basis(K+1), m_table(m_basis), m_moments(m_basis.size())
+    {}
+    
+    void
+    build(const element<T>& elem)
+    {
+        build_matrices(elem);
+    }
+    
+    const gradrec_matrix_type&
+    as_matrix(void) const
+    {
+        return gradrec_matrix;
+    }
+    
+    const local_matrix_type&
+    local_contrib(void) const
+    {
+        return local_contrib_matrix;
+    }
+};
@@ -0,0 +1,148 @@
+/*
+ *       /\
+ *      /__\        Matteo Cicuttin (C) 2016 - matteo.cicuttin@enpc.fr
+ *     /_\/_\
+ *    /\    /\      École Nationale des Ponts et Chaussées
+ *   /__\  /__\     CERMICS
+ *  /_\/_\/_\/_\
+ *
+ * This is a simple 1D code for the demonstration of the Hybrid High Order
+ * numerical method. It is intended only to show the details of all the
+ * involved operators (projection, gradient reconstruction, stabilization)
+ * step by step.
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <armadillo>
+
+#include "element.hpp"
+#include "basis.hpp"
+#include "basis_table.hpp"
+#include "moment_table.hpp"
+#include "fixed_degree.hpp"
+#include "local_solver.hpp"
+#include "fixed_gradient_reconstruction.hpp"
+
+/* Stabilization of compile-time degree K, the fixed-size counterpart of
+ * stabilization_operator. It takes the reconstruction matrix computed by
+ * fixed_gradient_reconstruction_operator<T, K, Family>.
+ */
+template<typename T, size_t K, typename Family = scaled_monomials>
+class fixed_stabilization_operator
+{
+    typedef fixed_gradient_reconstruction_operator<T, K, Family>  gr_type;
+    
+public:
+    static const size_t cell_size   = gr_type::cell_size;
+    static const size_t dofs_size   = gr_type::dofs_size;
+    static const size_t rec_size    = gr_type::rec_size;
+    
+    typedef typename gr_type::gradrec_matrix_type   gradrec_matrix_type;
+    typedef typename gr_type::local_matrix_type     local_matrix_type;
+    
+private:
+    local_matrix_type       stab_matrix;
+    basis<T, Family>        m_basis;
+    basis_table<T, Family>  m_table;
+    moment_table<T, Family> m_moments;
+    
+    void
+    build_matrices(const element<T>& elem, const gradrec_matrix_type& gradrec_matrix)
+    {
+        /* M1 is the mass matrix of the cell basis, M2 the mixed mass matrix
+         * between the cell basis and the non-constant reconstruction basis */
+        typename arma::Mat<T>::template fixed<cell_size, cell_size> M1;
+        typename arma::Mat<T>::template fixed<cell_size, rec_size>  M2;
+        auto h = elem.measure();
+        auto& M_ref = m_moments.reference_mass();
+        
+        for (size_t j = 0; j < cell_size; j++)
+            for (size_t i = 0; i < cell_size; i++)
+                M1(i,j) = h * M_ref(i,j);
+        
+        for (size_t j = 0; j < rec_size; j++)
+            for (size_t i = 0; i < cell_size; i++)
+                M2(i,j) = h * M_ref(i,j+1);
+        
+        /* proj1 = I_T - M1^-1 M2 R, the difference between the cell unknowns
+         * and the L2 projection of the reconstruction on the cell */
+        typename arma::Mat<T>::template fixed<cell_size, dofs_size> proj1;
+        proj1.zeros();
+        for (size_t j = 0; j < dofs_size; j++)
+            for (size_t i = 0; i < cell_size; i++)
+                for (size_t k = 0; k < rec_size; k++)
+                    proj1(i,j) -= M2(i,k) * gradrec_matrix(k,j);
+        
+        if (Family::orthogonal)
+        {
+            /* M1 is diagonal, the solve is just a scaling of the rows */
+            for (size_t j = 0; j < dofs_size; j++)
+                for (size_t i = 0; i < cell_size; i++)
+                    proj1(i,j) /= M1(i,i);
+        }
+        else
+        {
+            fixed_cholesky_factor<cell_size>(M1.memptr());
+            fixed_cholesky_solve<cell_size, dofs_size>(M1.memptr(), proj1.memptr());
+        }
+        
+        for (size_t i = 0; i < cell_size; i++)
+            proj1(i,i) += 1;
+        
+        /* The face mass matrix is the scalar 1, as phiF(0) is always 1 */
+        stab_matrix.zeros();
+        for (size_t face = 0; face < 2; face++)
+        {
+            auto& phiF = m_table.face_functions(face);
+            
+            /* B is the difference on the face between the trace of the
+             * reconstruction corrected by proj1 and the face unknown */
+            typename arma::Col<T>::template fixed<dofs_size> B;
+            B.zeros();
+            for (size_t j = 0; j < dofs_size; j++)
+            {
+                for (size_t k = 0; k < rec_size; k++)
+                    B(j) += phiF(k+1) * gradrec_matrix(k,j);
+                for (size_t k = 0; k < cell_size; k++)
+                    B(j) += phiF(k) * proj1(k,j);
+            }
+            B(cell_size+face) -= 1;
+            
+            for (size_t j = 0; j < dofs_size; j++)
+                for (size_t i = 0; i < dofs_size; i++)
+                    stab_matrix(i,j) += B(i) * B(j) / h;
+        }
+    }
+    
+public:
+    fixed_stabilization_operator()
+        : m_basis(K+1), m_table(m_basis), m_moments(m_basis.size())
+    {}
+    
+    void
+    build(const element<T>& elem, const gradrec_matrix_type& gradrec_matrix)
+    {
+        build_matrices(elem, gradrec_matrix);
+    }
+    
+    const local_matrix_type&
+    local_contrib(void) const
+    {
+        return stab_matrix;
+    }
+};
@@ -46,7 +46,7 @@
  *
  */
 
-template<typename T>
+template<typename T, typename Family = scaled_monomials>
 static int
 run_example_gr(const run_parameters& rp)
 {
@@ -66,10 +66,12 @@ run_example_gr(const run_parameters& rp)
     
     size_t pos = 0;
     
+    gradient_reconstruction_operator<T, Family> gr(rp.degree);
+    projector<T, Family> proj(rp.degree);
+    
     for (auto& elem : mesh)
     {
         /* Compute projection on current element */
-        gradient_reconstruction_operator<T> gr(rp.degree);
         gr.build(elem);
         
         auto pf = [](T p) -> T {
@@ -77,7 +79,6 @@ run_example_gr(const run_parameters& rp)
         };
         
         arma::Col<T> projection(rp.degree+3);
-        projector<T> proj(rp.degree);
         projection.zeros();
         projection.head(rp.degree+1) = proj.project(elem, pf);
         
@@ -89,13 +90,18 @@ run_example_gr(const run_parameters& rp)
         /* Compute some test points inside the element */
         auto tps = make_test_points(elem, rp.eval_per_elem);
         
-        /* Postprocess: recover the solution on the test points */
+        /* Postprocess: recover the solution on the test points. The
+         * reconstruction is computed once for the three evaluations. */
+        auto rec = gr.reconstruction(elem, projection);
+        auto grads = rec.gradient(tps);
+        auto pots_zeroavg = rec.potential_zeroavg(tps);
+        auto pots = rec.potential(tps);
         for (size_t j = 0; j < rp.eval_per_elem; j++)
         {
             x_val(pos) = tps[j];
-            grad_val(pos) = gr.reconstruct_gradient(elem, projection, tps[j]);
-            pot_zeroavg_val(pos) = gr.reconstruct_potential_zeroavg(elem, projection, tps[j]);
-            pot_val(pos) = gr.reconstruct_potential(elem, projection, tps[j]);
+            grad_val(pos) = grads(j);
+            pot_zeroavg_val(pos) = pots_zeroavg(j);
+            pot_val(pos) = pots(j);
             pos++;
         }
     }
@@ -28,13 +28,92 @@
 
 #pragma once
 
+#include <vector>
 #include <armadillo>
 
 #include "element.hpp"
-#include "quadrature.hpp"
 #include "basis.hpp"
+#include "basis_table.hpp"
+#include "moment_table.hpp"
+#include "local_solver.hpp"
 
-template<typename T>
+/* The potential reconstructed on one element, as its coefficients in the
+ * basis of degree k+1. The coefficients of the functions of degree >= 1 are
+ * R * dofs and the constant is the one of the cell unknowns, dofs(0): they
+ * are computed once, and the evaluator is then used on as many points as
+ * needed. "zeroavg" is the potential without the constant. */
+template<typename T, typename Family = scaled_monomials>
+class reconstruction_evaluator
+{
+    element<T>          m_elem;
+    basis<T, Family>    m_basis;
+    arma::Col<T>        m_coeffs;   /* of the functions of degree >= 1 */
+    T                   m_constant;
+    
+public:
+    reconstruction_evaluator()
+        : m_constant(0)
+    {}
+    
+    reconstruction_evaluator(const element<T>& elem, T constant, const arma::Col<T>& coeffs)
+        : m_elem(elem), m_basis(coeffs.n_elem), m_coeffs(coeffs), m_constant(constant)
+    {}
+    
+    T
+    constant(void) const
+    {
+        return m_constant;
+    }
+    
+    const arma::Col<T>&
+    coefficients(void) const
+    {
+        return m_coeffs;
+    }
+    
+    T
+    potential_zeroavg(T point) const
+    {
+        arma::Col<T> phi = m_basis.eval_functions(m_elem, point);
+        return dot(phi.tail(m_coeffs.n_elem), m_coeffs);
+    }
+    
+    T
+    potential(T point) const
+    {
+        return potential_zeroavg(point) + m_constant;
+    }
+    
+    T
+    gradient(T point) const
+    {
+        arma::Col<T> dphi = m_basis.eval_gradients(m_elem, point);
+        return dot(dphi.tail(m_coeffs.n_elem), m_coeffs);
+    }
+    
+    /* Batched versions, one basis evaluation for all the points */
+    arma::Col<T>
+    potential_zeroavg(const std::vector<T>& points) const
+    {
+        arma::Mat<T> phi = m_basis.eval_functions(m_elem, points);
+        return phi.tail_cols(m_coeffs.n_elem) * m_coeffs;
+    }
+    
+    arma::Col<T>
+    potential(const std::vector<T>& points) const
+    {
+        return potential_zeroavg(points) + m_constant;
+    }
+    
+    arma::Col<T>
+    gradient(const std::vector<T>& points) const
+    {
+        arma::Mat<T> dphi = m_basis.eval_gradients(m_elem, points);
+        return dphi.tail_cols(m_coeffs.n_elem) * m_coeffs;
+    }
+};
+
+template<typename T, typename Family = scaled_monomials>
 class gradient_reconstruction_operator
 {
     size_t          m_degree;
@@ -42,25 +121,16 @@ class gradient_reconstruction_operator
     arma::Mat<T>    stiffness_matrix;
     arma::Mat<T>    gradrec_matrix;
     arma::Mat<T>    local_contrib_matrix;
-    basis<T>        m_basis;
-    quadrature<T>   m_quad;
+    basis<T, Family>        m_basis;
+    basis_table<T, Family>  m_table;
+    moment_table<T, Family> m_moments;
 
     void
     build_matrices(const element<T>& elem)
     {
-        stiffness_matrix.resize(m_basis.size(), m_basis.size());
-        stiffness_matrix.zeros();
+        auto h = elem.measure();
         
-        auto qd = m_quad.integrate(elem);
-        for (auto& qp : qd)
-        {
-            auto qpoint  = qp.first;
-            auto qweight = qp.second;
-            
-            auto dphi = m_basis.eval_gradients(elem, qpoint);
-            
-            stiffness_matrix += qweight * dphi * dphi.t();
-        }
+        stiffness_matrix = m_moments.stiffness_matrix(elem);
         
         auto basis_k_size = m_basis.size() - 1;
         arma::Mat<T> MG = stiffness_matrix.submat(1,1, arma::size(basis_k_size, basis_k_size));
@@ -72,20 +142,19 @@ class gradient_reconstruction_operator
         auto blocksz = arma::size(bg_rows, basis_k_size);
         BG.submat(0,0,blocksz) = stiffness_matrix.submat(1,0,blocksz);
         
-        auto faces = elem.faces();
-        
-        auto phiF1 = m_basis.eval_functions(elem, faces[0]);
-        auto dphiF1 = m_basis.eval_gradients(elem, faces[0]);
-        auto phiF2 = m_basis.eval_functions(elem, faces[1]);
-        auto dphiF2 = m_basis.eval_gradients(elem, faces[1]);
+        /* Face gradients in the table are not scaled by 1/h */
+        auto& phiF1 = m_table.face_functions(0);
+        auto& dphiF1 = m_table.face_gradients(0);
+        auto& phiF2 = m_table.face_functions(1);
+        auto& dphiF2 = m_table.face_gradients(1);
         
         /* Beware of the signs: they are due to the normals */
-        BG.submat(0,0,blocksz) += + dphiF1.tail(bg_rows) * phiF1.head(basis_k_size).t();
-        BG.submat(0,0,blocksz) += - dphiF2.tail(bg_rows) * phiF2.head(basis_k_size).t();
-        BG.col(basis_k_size)    = - dphiF1.tail(bg_rows); // * phiF1(0), but not needed, it is always 1
-        BG.col(basis_k_size+1)  = + dphiF2.tail(bg_rows); // * phiF2(0), but not needed, it is always 1
+        BG.submat(0,0,blocksz) += + dphiF1.tail(bg_rows) * phiF1.head(basis_k_size).t() / h;
+        BG.submat(0,0,blocksz) += - dphiF2.tail(bg_rows) * phiF2.head(basis_k_size).t() / h;
+        BG.col(basis_k_size)    = - dphiF1.tail(bg_rows) / h; // * phiF1(0), but not needed, it is always 1
+        BG.col(basis_k_size+1)  = + dphiF2.tail(bg_rows) / h; // * phiF2(0), but not needed, it is always 1
         
-        gradrec_matrix = solve(MG, BG);
+        gradrec_matrix = spd_solver<T>(MG).solve(BG);
         
         local_contrib_matrix = BG.t() * gradrec_matrix;
     }
@@ -94,15 +163,17 @@ public:
     gradient_reconstruction_operator()
         : m_degree(1)
     {
-        m_basis = basis<T>(2);
-        m_quad = quadrature<T>(4);
+        m_basis = basis<T, Family>(2);
+        m_table = basis_table<T, Family>(m_basis);
+        m_moments = moment_table<T, Family>(m_basis.size());
     }
     
     gradient_reconstruction_operator(size_t degree)
         : m_degree(degree)
     {
-        m_basis = basis<T>( m_degree+1 );
-        m_quad = quadrature<T>( 2*(m_degree+1) );
+        m_basis = basis<T, Family>( m_degree+1 );
+        m_table = basis_table<T, Family>(m_basis);
+        m_moments = moment_table<T, Family>(m_basis.size());
     }
     
     void
@@ -111,28 +182,53 @@ public:
         build_matrices(elem);
     }
     
+    /* Reconstruct the potential of dofs on elem once, to evaluate it on
+     * many points */
+    reconstruction_evaluator<T, Family>
+    reconstruction(const element<T>& elem, const arma::Col<T>& dofs) const
+    {
+        return reconstruction_evaluator<T, Family>(elem, dofs(0), gradrec_matrix * dofs);
+    }
+    
+    /* Shorthands for a single use of the reconstruction: to evaluate more
+     * than one of them on the same dofs, use reconstruction() */
     T
     reconstruct_potential_zeroavg(const element<T>& elem, const arma::Col<T>& dofs, T point)
     {
-        auto basis_size = m_basis.size() - 1;
-        auto phi = m_basis.eval_functions(elem, point).tail(basis_size);
-        return dot(phi, gradrec_matrix * dofs);
+        return reconstruction(elem, dofs).potential_zeroavg(point);
     }
     
     T
     reconstruct_potential(const element<T>& elem, const arma::Col<T>& dofs, T point)
     {
-        auto basis_size = m_basis.size() - 1;
-        auto phi = m_basis.eval_functions(elem, point).tail(basis_size);
-        return dot(phi, gradrec_matrix * dofs) + dofs(0);
+        return reconstruction(elem, dofs).potential(point);
     }
     
     T
     reconstruct_gradient(const element<T>& elem, const arma::Col<T>& dofs, T point)
     {
-        auto basis_size = m_basis.size() - 1;
-        auto dphi = m_basis.eval_gradients(elem, point).tail(basis_size);
-        return dot(dphi, gradrec_matrix * dofs);
+        return reconstruction(elem, dofs).gradient(point);
+    }
+    
+    arma::Col<T>
+    reconstruct_potential_zeroavg(const element<T>& elem, const arma::Col<T>& dofs,
+                                  const std::vector<T>& points)
+    {
+        return reconstruction(elem, dofs).potential_zeroavg(points);
+    }
+    
+    arma::Col<T>
+    reconstruct_potential(const element<T>& elem, const arma::Col<T>& dofs,
+                          const std::vector<T>& points)
+    {
+        return reconstruction(elem, dofs).potential(points);
+    }
+    
+    arma::Col<T>
+    reconstruct_gradient(const element<T>& elem, const arma::Col<T>& dofs,
+                         const std::vector<T>& points)
+    {
+        return reconstruction(elem, dofs).gradient(points);
     }
     
     arma::Mat<T>
@@ -27,8 +27,10 @@
  */
 
 #include <iostream>
+#include <string>
 #include <cstdlib>
 #include <unistd.h>
+#include <getopt.h>
 
 #include "common.h"
 
@@ -37,6 +39,32 @@
 #include "projector_demo.hpp"
 #include "gr_demo.hpp"
 #include "diffusion_demo.hpp"
+#include "profiler.hpp"
+
+static const char *
+solver_name(global_solver solver)
+{
+    switch (solver)
+    {
+        case global_solver::PCG:            return "pcg";
+        case global_solver::TRIDIAGONAL:    return "tridiag";
+        case global_solver::MULTIGRID:      return "mg";
+        case global_solver::STREAMING:      return "stream";
+        default:                            return "cg";
+    }
+}
+
+static const char *
+preconditioner_name(preconditioner_type preconditioner)
+{
+    switch (preconditioner)
+    {
+        case preconditioner_type::JACOBI:               return "jacobi";
+        case preconditioner_type::SSOR:                 return "ssor";
+        case preconditioner_type::INCOMPLETE_CHOLESKY:  return "ic";
+        default:                                        return "none";
+    }
+}
 
 static void
 usage(char *progname)
@@ -44,7 +72,23 @@ usage(char *progname)
     std::cout << " -k <degree>      Polynomial order. Default = 1." << std::endl;
     std::cout << " -n <gridelem>    Number of grid elements. Default = 2." << std::endl;
     std::cout << " -p <numpts>      Number of evaluation points per element. Default = 5." << std::endl;
+    std::cout << " -b <basis>       Cell basis: monomial or legendre. Default = monomial." << std::endl;
+    std::cout << " -s <solver>      Face system solver: cg, pcg, tridiag, mg or stream" << std::endl;
+    std::cout << "                  (streaming, serial: it ignores -t). Default = cg." << std::endl;
+    std::cout << " -c <precond>     Preconditioner of pcg: none, jacobi, ssor or ic. Default = none." << std::endl;
+    std::cout << " -m <cycle>       Multigrid cycle: v or w. Default = v." << std::endl;
+    std::cout << " -g <smoother>    Multigrid smoother: jacobi or gs. Default = gs." << std::endl;
+    std::cout << " -t <threads>     Number of threads. Default = 1." << std::endl;
+    std::cout << " -r               Rebuild the local operators on each element instead of" << std::endl;
+    std::cout << "                  scaling the ones of the reference element." << std::endl;
+    std::cout << " -q               Do not print the progress of the solver." << std::endl;
     std::cout << " -f <filename>    Name of the solution output file." << std::endl;
+    std::cout << " --profile        Print the time spent in each phase of the example." << std::endl;
+    std::cout << " --profile-detail Same as --profile, with the timers of the operations" << std::endl;
+    std::cout << "                  on each element. They slow down the phases they are in." << std::endl;
+    std::cout << " --profile-out <filename>" << std::endl;
+    std::cout << "                  Write the profile to filename, as JSON if its extension" << std::endl;
+    std::cout << "                  is .json and as CSV otherwise." << std::endl;
     std::cout << " -h               Print this help." << std::endl;
     
 }
@@ -60,17 +104,78 @@ main(int argc, char **argv)
     rp.degree           = 1;
     rp.num_elements     = 2;
     rp.eval_per_elem    = 5;
+    rp.family           = basis_family::MONOMIALS;
+    rp.solver           = global_solver::CG;
+    rp.preconditioner   = preconditioner_type::NONE;
+    rp.mg_cycle         = multigrid_cycle::V;
+    rp.mg_smoother      = multigrid_smoother::GAUSS_SEIDEL;
+    rp.num_threads      = 1;
+    rp.cache_operators  = true;
+    rp.quiet            = false;
+    
+    bool profile = false;
+    bool profile_detail = false;
+    const char *profile_out = nullptr;
+    
+    /* The long options have no short form */
+    enum { OPT_PROFILE = 256, OPT_PROFILE_DETAIL, OPT_PROFILE_OUT };
+    static struct option long_options[] = {
+        { "profile",        no_argument,        nullptr,    OPT_PROFILE },
+        { "profile-detail", no_argument,        nullptr,    OPT_PROFILE_DETAIL },
+        { "profile-out",    required_argument,  nullptr,    OPT_PROFILE_OUT },
+        { nullptr,          0,                  nullptr,    0 }
+    };
     
     int ch;
     
-    while ( (ch = getopt(argc, argv, "dhk:n:f:p:")) != -1 )
+    while ( (ch = getopt_long(argc, argv, "b:c:dg:hk:m:n:f:p:qrs:t:", long_options, nullptr)) != -1 )
     {
         switch(ch)
         {
+            case 'b':
+                if ( strcmp(optarg, "monomial") == 0 )
+                    rp.family = basis_family::MONOMIALS;
+                else if ( strcmp(optarg, "legendre") == 0 )
+                    rp.family = basis_family::LEGENDRE;
+                else
+                {
+                    std::cout << "Unknown basis. Falling back to monomial." << std::endl;
+                    rp.family = basis_family::MONOMIALS;
+                }
+                break;
+                
+            case 'c':
+                if ( strcmp(optarg, "none") == 0 )
+                    rp.preconditioner = preconditioner_type::NONE;
+                else if ( strcmp(optarg, "jacobi") == 0 )
+                    rp.preconditioner = preconditioner_type::JACOBI;
+                else if ( strcmp(optarg, "ssor") == 0 )
+                    rp.preconditioner = preconditioner_type::SSOR;
+                else if ( strcmp(optarg, "ic") == 0 )
+                    rp.preconditioner = preconditioner_type::INCOMPLETE_CHOLESKY;
+                else
+                {
+                    std::cout << "Unknown preconditioner. Falling back to none." << std::endl;
+                    rp.preconditioner = preconditioner_type::NONE;
+                }
+                break;
+                
             case 'd':
                 rp.draw = true;
                 break;
                 
+            case 'g':
+                if ( strcmp(optarg, "jacobi") == 0 )
+                    rp.mg_smoother = multigrid_smoother::JACOBI;
+                else if ( strcmp(optarg, "gs") == 0 )
+                    rp.mg_smoother = multigrid_smoother::GAUSS_SEIDEL;
+                else
+                {
+                    std::cout << "Unknown smoother. Falling back to gs." << std::endl;
+                    rp.mg_smoother = multigrid_smoother::GAUSS_SEIDEL;
+                }
+                break;
+                
             case 'k':
                 rp.degree = atoi(optarg);
                 if (rp.degree < 0)
@@ -80,6 +185,18 @@ main(int argc, char **argv)
                 }
                 break;
                 
+            case 'm':
+                if ( strcmp(optarg, "v") == 0 )
+                    rp.mg_cycle = multigrid_cycle::V;
+                else if ( strcmp(optarg, "w") == 0 )
+                    rp.mg_cycle = multigrid_cycle::W;
+                else
+                {
+                    std::cout << "Unknown cycle. Falling back to v." << std::endl;
+                    rp.mg_cycle = multigrid_cycle::V;
+                }
+                break;
+                
             case 'n':
                 rp.num_elements = atoi(optarg);
                 break;
@@ -88,10 +205,58 @@ main(int argc, char **argv)
                 rp.eval_per_elem = atoi(optarg);
                 break;
                 
+            case 'q':
+                rp.quiet = true;
+                break;
+                
+            case 'r':
+                rp.cache_operators = false;
+                break;
+                
+            case 's':
+                if ( strcmp(optarg, "cg") == 0 )
+                    rp.solver = global_solver::CG;
+                else if ( strcmp(optarg, "pcg") == 0 )
+                    rp.solver = global_solver::PCG;
+                else if ( strcmp(optarg, "tridiag") == 0 )
+                    rp.solver = global_solver::TRIDIAGONAL;
+                else if ( strcmp(optarg, "mg") == 0 )
+                    rp.solver = global_solver::MULTIGRID;
+                else if ( strcmp(optarg, "stream") == 0 )
+                    rp.solver = global_solver::STREAMING;
+                else
+                {
+                    std::cout << "Unknown solver. Falling back to cg." << std::endl;
+                    rp.solver = global_solver::CG;
+                }
+                break;
+                
+            case 't':
+                rp.num_threads = atoi(optarg);
+                if (rp.num_threads < 1)
+                {
+                    std::cout << "Number of threads must be positive. Falling back to 1." << std::endl;
+                    rp.num_threads = 1;
+                }
+                break;
+                
             case 'f':
                 rp.filename = optarg;
                 break;
                 
+            case OPT_PROFILE:
+                profile = true;
+                break;
+                
+            case OPT_PROFILE_DETAIL:
+                profile = true;
+                profile_detail = true;
+                break;
+                
+            case OPT_PROFILE_OUT:
+                profile_out = optarg;
+                break;
+                
             case 'h':
             case '?':
             default:
@@ -110,22 +275,75 @@ main(int argc, char **argv)
         exit(1);
     }
     
+    if (rp.solver == global_solver::STREAMING and rp.num_threads > 1)
+    {
+        std::cout << "The streaming solver is serial: running with 1 thread." << std::endl;
+        rp.num_threads = 1;
+    }
+    
     std::cout << "Running with the following parameters:" << std::endl;
     std::cout << "  K = " << rp.degree << std::endl;
     std::cout << "  N = " << rp.num_elements << std::endl;
+    std::cout << "  basis = " << (rp.family == basis_family::LEGENDRE ? "legendre" : "monomial") << std::endl;
+    std::cout << "  solver = " << solver_name(rp.solver) << std::endl;
+    if (rp.solver == global_solver::PCG)
+        std::cout << "  preconditioner = " << preconditioner_name(rp.preconditioner) << std::endl;
+    if (rp.solver == global_solver::MULTIGRID)
+    {
+        std::cout << "  cycle = " << (rp.mg_cycle == multigrid_cycle::W ? "w" : "v") << std::endl;
+        std::cout << "  smoother = " << (rp.mg_smoother == multigrid_smoother::JACOBI ? "jacobi" : "gs") << std::endl;
+    }
+    std::cout << "  threads = " << rp.num_threads << std::endl;
+    std::cout << "  operator cache = " << (rp.cache_operators ? "on" : "off") << std::endl;
     std::cout << "  output filename = " << (rp.filename == nullptr ? "(none)" : rp.filename) << std::endl;
     
+    if (profile or profile_out)
+    {
+#ifdef HHO_PROFILING
+        profiler::instance().enable(true, profile_detail);
+#else
+        std::cout << "Profiling is not compiled in: configure with -DPROFILING=ON." << std::endl;
+#endif
+    }
+    
+    bool legendre = (rp.family == basis_family::LEGENDRE);
+    int ret = 0;
+    
     if ( strcmp(argv[0], "projection") == 0 )
-        return run_example_projection<RealType>(rp);
+        ret = legendre ? run_example_projection<RealType, scaled_legendre>(rp)
+                       : run_example_projection<RealType, scaled_monomials>(rp);
     
-    if ( strcmp(argv[0], "gradrec") == 0 )
-        return run_example_gr<RealType>(rp);
+    else if ( strcmp(argv[0], "gradrec") == 0 )
+        ret = legendre ? run_example_gr<RealType, scaled_legendre>(rp)
+                       : run_example_gr<RealType, scaled_monomials>(rp);
     
-    if ( strcmp(argv[0], "diffusion") == 0 )
-        return run_example_diffusion<RealType>(rp);
+    else if ( strcmp(argv[0], "diffusion") == 0 )
+        ret = legendre ? run_example_diffusion<RealType, scaled_legendre>(rp)
+                       : run_example_diffusion<RealType, scaled_monomials>(rp);
     
+#ifdef HHO_PROFILING
+    if (profile)
+        profiler::instance().print_summary(std::cout);
+    
+    if (profile_out)
+    {
+        profiler::metadata_type metadata = {
+            { "example",        argv[0] },
+            { "degree",         std::to_string(rp.degree) },
+            { "elements",       std::to_string(rp.num_elements) },
+            { "basis",          legendre ? "legendre" : "monomial" },
+            { "solver",         solver_name(rp.solver) },
+            { "preconditioner", preconditioner_name(rp.preconditioner) },
+            { "threads",        std::to_string(rp.num_threads) },
+            { "cache",          rp.cache_operators ? "on" : "off" }
+        };
+        
+        if ( not profiler::instance().dump(profile_out, metadata) )
+            std::cout << "Cannot write the profile to " << profile_out << std::endl;
+    }
+#endif
     
-    return 0;
+    return ret;
 }
 
 
@@ -0,0 +1,158 @@
+/*
+ *       /\
+ *      /__\        Matteo Cicuttin (C) 2016 - matteo.cicuttin@enpc.fr
+ *     /_\/_\
+ *    /\    /\      École Nationale des Ponts et Chaussées
+ *   /__\  /__\     CERMICS
+ *  /_\/_\/_\/_\
+ *
+ * This is a simple 1D code for the demonstration of the Hybrid High Order
+ * numerical method. It is intended only to show the details of all the
+ * involved operators (projection, gradient reconstruction, stabilization)
+ * step by step.
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <armadillo>
+
+#include "element.hpp"
+#include "basis.hpp"
+#include "basis_table.hpp"
+#include "moment_table.hpp"
+#include "local_solver.hpp"
+
+/* Gradient reconstruction and stabilization built together. The two
+ * operators use the same basis, moments and face values, so here they are
+ * computed in a single pass:
+ *
+ *  - the stiffness and the mass matrix are scaled from the same moment table;
+ *  - the face values of the basis are read once and used by both;
+ *  - the face mass matrix is the scalar 1 (phiF(0) = 1), so the face
+ *    projections need no solve;
+ *  - the result is directly A + S.
+ *
+ * It gives the same matrices as gradient_reconstruction_operator followed by
+ * stabilization_operator.
+ */
+template<typename T, typename Family = scaled_monomials>
+class hho_local_operator
+{
+    size_t                  m_degree;
+    
+    arma::Mat<T>            stiffness_matrix;
+    arma::Mat<T>            mass_matrix;
+    arma::Mat<T>            gradrec_matrix;
+    arma::Mat<T>            local_contrib_matrix;
+    basis<T, Family>        m_basis;
+    basis_table<T, Family>  m_table;
+    moment_table<T, Family> m_moments;
+    
+    void
+    build_matrices(const element<T>& elem)
+    {
+        auto basis_size = m_basis.size();
+        auto cell_size = m_degree + 1;
+        auto rec_size = basis_size - 1;
+        auto h = elem.measure();
+        
+        stiffness_matrix = m_moments.stiffness_matrix(elem);
+        mass_matrix = m_moments.mass_matrix(elem);
+        
+        /* Face values, gradients in the table are not scaled by 1/h */
+        auto& phiF1 = m_table.face_functions(0);
+        auto& dphiF1 = m_table.face_gradients(0);
+        auto& phiF2 = m_table.face_functions(1);
+        auto& dphiF2 = m_table.face_gradients(1);
+        
+        /* Gradient reconstruction: MG R = BG. Beware of the signs of the
+         * face terms: they are due to the normals. */
+        arma::Mat<T> MG = stiffness_matrix.submat(1, 1, arma::size(rec_size, rec_size));
+        
+        arma::Mat<T> BG(rec_size, cell_size+2);
+        auto blocksz = arma::size(rec_size, cell_size);
+        BG.submat(0, 0, blocksz) = stiffness_matrix.submat(1, 0, blocksz);
+        BG.submat(0, 0, blocksz) += + dphiF1.tail(rec_size) * phiF1.head(cell_size).t() / h;
+        BG.submat(0, 0, blocksz) += - dphiF2.tail(rec_size) * phiF2.head(cell_size).t() / h;
+        BG.col(cell_size)   = - dphiF1.tail(rec_size) / h;
+        BG.col(cell_size+1) = + dphiF2.tail(rec_size) / h;
+        
+        gradrec_matrix = spd_solver<T>(MG).solve(BG);
+        
+        /* proj1 = I_T - M1^-1 M2 R, the difference between the cell
+         * unknowns and the L2 projection of the reconstruction on the cell */
+        auto cellsz = arma::size(cell_size, cell_size);
+        arma::Mat<T> M1 = mass_matrix.submat(0, 0, cellsz);
+        arma::Mat<T> M2R = mass_matrix.submat(0, 1, arma::size(cell_size, rec_size)) * gradrec_matrix;
+        arma::Mat<T> proj1;
+        if (Family::orthogonal)
+        {
+            /* M1 is diagonal, the solve is just a scaling of the rows */
+            proj1 = -M2R;
+            for (size_t i = 0; i < cell_size; i++)
+                proj1.row(i) /= M1(i,i);
+        }
+        else
+            proj1 = -spd_solver<T>(M1).solve(M2R);
+        
+        for (size_t i = 0; i < cell_size; i++)
+            proj1(i,i) += 1;
+        
+        /* A = BG^T R, then the stabilization of each face is added */
+        local_contrib_matrix = BG.t() * gradrec_matrix;
+        
+        arma::Row<T> B1 = phiF1.tail(rec_size).t() * gradrec_matrix
+                        + phiF1.head(cell_size).t() * proj1;
+        B1(cell_size) -= 1;
+        local_contrib_matrix += B1.t() * B1 / h;
+        
+        arma::Row<T> B2 = phiF2.tail(rec_size).t() * gradrec_matrix
+                        + phiF2.head(cell_size).t() * proj1;
+        B2(cell_size+1) -= 1;
+        local_contrib_matrix += B2.t() * B2 / h;
+    }
+    
+public:
+    hho_local_operator()
+        : m_degree(1), m_basis(2), m_table(m_basis), m_moments(m_basis.size())
+    {}
+    
+    hho_local_operator(size_t degree)
+        : m_degree(degree), m_basis(degree+1), m_table(m_basis),
+          m_moments(m_basis.size())
+    {}
+    
+    void
+    build(const element<T>& elem)
+    {
+        build_matrices(elem);
+    }
+    
+    /* Gradient reconstruction matrix */
+    const arma::Mat<T>&
+    gradrec(void) const
+    {
+        return gradrec_matrix;
+    }
+    
+    /* A + S */
+    const arma::Mat<T>&
+    local_contrib(void) const
+    {
+        return local_contrib_matrix;
+    }
+};
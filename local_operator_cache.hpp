@@ -0,0 +1,140 @@
+/*
+ *       /\
+ *      /__\        Matteo Cicuttin (C) 2016 - matteo.cicuttin@enpc.fr
+ *     /_\/_\
+ *    /\    /\      École Nationale des Ponts et Chaussées
+ *   /__\  /__\     CERMICS
+ *  /_\/_\/_\/_\
+ *
+ * This is a simple 1D code for the demonstration of the Hybrid High Order
+ * numerical method. It is intended only to show the details of all the
+ * involved operators (projection, gradient reconstruction, stabilization)
+ * step by step.
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <armadillo>
+
+#include "element.hpp"
+#include "basis.hpp"
+#include "hho_local_operator.hpp"
+#include "local_solver.hpp"
+
+/* The basis is scaled with (x - bar)/h, so on an element of measure h the
+ * mass matrices scale as h and the stiffness as 1/h. As a consequence the
+ * gradient reconstruction matrix R does not depend on h, and both A = BG^T R
+ * and the stabilization S scale exactly as 1/h:
+ *
+ *   R(h) = R(1),   A(h) + S(h) = (A(1) + S(1)) / h.
+ *
+ * This class builds the local operators once on a reference element of unit
+ * measure and gives the ones of any element through this scaling law, so the
+ * element loop of the diffusion solver does not have to rebuild them. It also
+ * keeps the quantities of the static condensation that do not depend on the
+ * right hand side:
+ *
+ *   AL = K_TT^-1 K_TF              (does not depend on h)
+ *   AC = K_FF - K_FT AL            (scales as 1/h)
+ *   bL = K_TT^-1 f_T               (h * K_TT(1)^-1 f_T)
+ *   bC = - K_FT bL                 (- K_FT(1) K_TT(1)^-1 f_T, no h)
+ */
+template<typename T, typename Family = scaled_monomials>
+class local_operator_cache
+{
+    size_t          m_cell_size;
+    arma::Mat<T>    m_gradrec;          /* R */
+    arma::Mat<T>    m_local_contrib;    /* A + S on the reference element */
+    arma::Mat<T>    m_cell_elimination; /* AL */
+    spd_solver<T>   m_cell_solver;      /* factor of K_TT on the reference element */
+    arma::Mat<T>    m_condensed;        /* AC on the reference element */
+    arma::Mat<T>    m_condensed_rhs;    /* - K_FT K_TT^-1 = - AL^T on the reference element */
+    
+public:
+    local_operator_cache()
+        : m_cell_size(0)
+    {}
+    
+    local_operator_cache(size_t degree)
+        : m_cell_size(degree+1)
+    {
+        element<T> ref_elem(0, 1);
+        
+        hho_local_operator<T, Family> lop(degree);
+        lop.build(ref_elem);
+        
+        m_gradrec = lop.gradrec();
+        m_local_contrib = lop.local_contrib();
+        
+        auto cs = m_cell_size;
+        arma::Mat<T> K_TT = m_local_contrib.submat(0, 0, arma::size(cs, cs));
+        arma::Mat<T> K_TF = m_local_contrib.submat(0, cs, arma::size(cs, 2));
+        arma::Mat<T> K_FT = m_local_contrib.submat(cs, 0, arma::size(2, cs));
+        arma::Mat<T> K_FF = m_local_contrib.submat(cs, cs, arma::size(2, 2));
+        
+        /* K_TT is not inverted: with the monomials it becomes badly
+         * conditioned as k grows, and the solves with its factor are more
+         * accurate. As the local matrix is symmetric, K_FT K_TT^-1 is the
+         * transpose of AL. */
+        m_cell_solver.factorize(K_TT);
+        m_cell_elimination = m_cell_solver.solve(K_TF);
+        m_condensed = K_FF - K_FT * m_cell_elimination;
+        m_condensed_rhs = - m_cell_elimination.t();
+    }
+    
+    /* Gradient reconstruction matrix, the same on every element */
+    const arma::Mat<T>&
+    gradrec(void) const
+    {
+        return m_gradrec;
+    }
+    
+    /* A + S on the element */
+    arma::Mat<T>
+    local_contrib(const element<T>& elem) const
+    {
+        return m_local_contrib / elem.measure();
+    }
+    
+    /* AL = K_TT^-1 K_TF, the same on every element */
+    const arma::Mat<T>&
+    cell_elimination(void) const
+    {
+        return m_cell_elimination;
+    }
+    
+    /* bL = K_TT^-1 f_T, where f_T is the projection of the load on the cell */
+    arma::Col<T>
+    cell_solution(const element<T>& elem, const arma::Col<T>& f_T) const
+    {
+        return elem.measure() * m_cell_solver.solve(f_T);
+    }
+    
+    /* AC = K_FF - K_FT K_TT^-1 K_TF */
+    arma::Mat<T>
+    condensed_matrix(const element<T>& elem) const
+    {
+        return m_condensed / elem.measure();
+    }
+    
+    /* bC = - K_FT K_TT^-1 f_T, it does not depend on h */
+    arma::Col<T>
+    condensed_rhs(const arma::Col<T>& f_T) const
+    {
+        return m_condensed_rhs * f_T;
+    }
+};
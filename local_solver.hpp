@@ -0,0 +1,136 @@
+/*
+ *       /\
+ *      /__\        Matteo Cicuttin (C) 2016 - matteo.cicuttin@enpc.fr
+ *     /_\/_\
+ *    /\    /\      École Nationale des Ponts et Chaussées
+ *   /__\  /__\     CERMICS
+ *  /_\/_\/_\/_\
+ *
+ * This is a simple 1D code for the demonstration of the Hybrid High Order
+ * numerical method. It is intended only to show the details of all the
+ * involved operators (projection, gradient reconstruction, stabilization)
+ * step by step.
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <armadillo>
+
+/* Solvers for the small dense systems of the local operators. The matrices
+ * of these systems (stiffness of the non-constant functions, cell mass, cell
+ * block of A + S) are all SPD, so they are factorized with Cholesky instead
+ * of the LU done by the generic solve(). The factor is computed once and it
+ * is reused for all the right hand sides.
+ */
+
+/* Cholesky factorization of a matrix with runtime size. If the matrix turns
+ * out not to be numerically SPD, it falls back to the generic solve(). */
+template<typename T>
+class spd_solver
+{
+    arma::Mat<T>    m_factor;   /* upper triangular R, with A = R^T R */
+    arma::Mat<T>    m_matrix;   /* only if the factorization failed */
+    bool            m_spd;
+    
+public:
+    spd_solver()
+        : m_spd(false)
+    {}
+    
+    spd_solver(const arma::Mat<T>& A)
+    {
+        factorize(A);
+    }
+    
+    void
+    factorize(const arma::Mat<T>& A)
+    {
+        m_spd = chol(m_factor, A);
+        if (!m_spd)
+            m_matrix = A;
+    }
+    
+    /* Solve A X = B, for all the columns of B */
+    arma::Mat<T>
+    solve(const arma::Mat<T>& B) const
+    {
+        if (!m_spd)
+            return arma::solve(m_matrix, B);
+        
+        arma::Mat<T> Y = arma::solve(arma::trimatl(m_factor.t()), B);
+        return arma::solve(arma::trimatu(m_factor), Y);
+    }
+};
+
+/* The same for matrices of compile-time size N, used by the operators of
+ * fixed degree: in-place Cholesky factorization of the N x N SPD matrix A,
+ * stored column-major. Its lower triangle is overwritten with L, A = L L^T,
+ * and the upper triangle is not referenced. It does not allocate.
+ */
+template<size_t N, typename T>
+void
+fixed_cholesky_factor(T *A)
+{
+    for (size_t j = 0; j < N; j++)
+    {
+        T d = A[j*N+j];
+        for (size_t k = 0; k < j; k++)
+            d -= A[k*N+j]*A[k*N+j];
+        
+        d = std::sqrt(d);
+        A[j*N+j] = d;
+        
+        for (size_t i = j+1; i < N; i++)
+        {
+            T s = A[j*N+i];
+            for (size_t k = 0; k < j; k++)
+                s -= A[k*N+i]*A[k*N+j];
+            A[j*N+i] = s/d;
+        }
+    }
+}
+
+/* Solve L L^T X = B in place for the M columns of the N x M matrix B, with L
+ * computed by fixed_cholesky_factor() */
+template<size_t N, size_t M, typename T>
+void
+fixed_cholesky_solve(const T *L, T *B)
+{
+    for (size_t c = 0; c < M; c++)
+    {
+        T *b = B + c*N;
+        
+        /* Forward substitution with L */
+        for (size_t i = 0; i < N; i++)
+        {
+            T s = b[i];
+            for (size_t k = 0; k < i; k++)
+                s -= L[k*N+i]*b[k];
+            b[i] = s/L[i*N+i];
+        }
+        
+        /* Back substitution with L^T */
+        for (size_t i = N; i-- > 0; )
+        {
+            T s = b[i];
+            for (size_t k = i+1; k < N; k++)
+                s -= L[i*N+k]*b[k];
+            b[i] = s/L[i*N+i];
+        }
+    }
+}
@@ -0,0 +1,101 @@
+/*
+ *       /\
+ *      /__\        Matteo Cicuttin (C) 2016 - matteo.cicuttin@enpc.fr
+ *     /_\/_\
+ *    /\    /\      École Nationale des Ponts et Chaussées
+ *   /__\  /__\     CERMICS
+ *  /_\/_\/_\/_\
+ *
+ * This is a simple 1D code for the demonstration of the Hybrid High Order
+ * numerical method. It is intended only to show the details of all the
+ * involved operators (projection, gradient reconstruction, stabilization)
+ * step by step.
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <armadillo>
+
+#include "element.hpp"
+#include "basis.hpp"
+
+/* Exact mass and stiffness matrices of a basis, without quadrature. The
+ * functions of the basis depend only on ep = (x - bar)/h, so on an element of
+ * measure h
+ *
+ *   int phi_i phi_j dx   = h   int phi_i(ep) phi_j(ep) dep
+ *   int phi_i' phi_j' dx = 1/h int d/dep phi_i d/dep phi_j dep
+ *
+ * where the integrals on the right are over [-1/2, 1/2] and are given in
+ * closed form by the family (for the monomials, the moments of ep). They are
+ * tabulated once for a given number of functions, and each element only
+ * scales the tables by h.
+ */
+template<typename T, typename Family = scaled_monomials>
+class moment_table
+{
+    arma::Mat<T>    m_mass, m_stiffness;
+    
+public:
+    moment_table()
+    {}
+    
+    /* Tables for the functions of degree 0 to size-1 */
+    explicit moment_table(size_t size)
+        : m_mass(size, size), m_stiffness(size, size)
+    {
+        for (size_t j = 0; j < size; j++)
+        {
+            for (size_t i = 0; i < size; i++)
+            {
+                m_mass(i,j) = Family::template mass<T>(i, j);
+                m_stiffness(i,j) = Family::template stiffness<T>(i, j);
+            }
+        }
+    }
+    
+    size_t
+    size(void) const
+    {
+        return m_mass.n_rows;
+    }
+    
+    /* Matrices of the reference element, of measure 1 */
+    const arma::Mat<T>&
+    reference_mass(void) const
+    {
+        return m_mass;
+    }
+    
+    const arma::Mat<T>&
+    reference_stiffness(void) const
+    {
+        return m_stiffness;
+    }
+    
+    arma::Mat<T>
+    mass_matrix(const element<T>& elem) const
+    {
+        return elem.measure() * m_mass;
+    }
+    
+    arma::Mat<T>
+    stiffness_matrix(const element<T>& elem) const
+    {
+        return m_stiffness / elem.measure();
+    }
+};
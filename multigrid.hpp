@@ -0,0 +1,429 @@
+/*
+ *       /\
+ *      /__\        Matteo Cicuttin (C) 2016 - matteo.cicuttin@enpc.fr
+ *     /_\/_\
+ *    /\    /\      École Nationale des Ponts et Chaussées
+ *   /__\  /__\     CERMICS
+ *  /_\/_\/_\/_\
+ *
+ * This is a simple 1D code for the demonstration of the Hybrid High Order
+ * numerical method. It is intended only to show the details of all the
+ * involved operators (projection, gradient reconstruction, stabilization)
+ * step by step.
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <cassert>
+#include <algorithm>
+#include <armadillo>
+
+#include "common.h"
+#include "element.hpp"
+#include "local_solver.hpp"
+#include "hho_local_operator.hpp"
+#include "local_operator_cache.hpp"
+#include "tridiagonal_solver.hpp"
+#include "solver_info.hpp"
+
+/* Geometric multigrid for the face system of the diffusion problem, with the
+ * Dirichlet faces eliminated. In 1D this system couples only neighbouring
+ * faces, so each level is stored as its three diagonals, as for
+ * tridiagonal_solve(): lower(i) = A(i,i-1), diag(i) = A(i,i) and
+ * upper(i) = A(i,i+1).
+ *
+ * The levels are added from the finest to the coarsest, each one with the
+ * coordinates of its interior faces. The matrices are not computed here: the
+ * caller assembles them on coarser and coarser meshes. The faces of each
+ * coarse mesh must be a subset of the faces of the finer one, and the
+ * prolongation is the linear interpolation between the coarse faces. The
+ * restriction is its transpose. The coarsest level is solved exactly.
+ *
+ * The vectors used by the cycles are allocated once per level, in
+ * add_level(), so solve() changes the state of the object: it is not
+ * reentrant and an instance must not be shared between threads.
+ */
+template<typename T>
+class face_multigrid
+{
+    struct level
+    {
+        arma::Col<T>        lower, diag, upper;
+        arma::Col<T>        faces;  /* coordinates of the interior faces */
+        
+        /* Prolongation from the next coarser level: fine face i gets
+         * weight_left(i) * coarse(left(i)) + weight_right(i) * coarse(left(i)+1).
+         * left(i) is the index of the coarse interval containing fine face i,
+         * counting the boundary face on the left as 0 */
+        std::vector<size_t> left;
+        arma::Col<T>        weight_left, weight_right;
+        
+        /* Residual of the level, reused by the smoother and the
+         * restriction, and the right hand side and the correction of the
+         * level when it is the coarse problem of the finer one: the cycles
+         * do not allocate, except for the exact solve on the coarsest one */
+        arma::Col<T>        work, rhs, correction;
+    };
+    
+    std::vector<level>  m_levels;
+    T                   m_x_min, m_x_max;   /* the boundary faces */
+    multigrid_cycle     m_cycle;
+    multigrid_smoother  m_smoother;
+    size_t              m_pre_smooth, m_post_smooth;
+    T                   m_jacobi_damping;
+    
+    /* r = b - A x, r must have the size of the level */
+    void
+    residual(const level& lev, const arma::Col<T>& x, const arma::Col<T>& b,
+             arma::Col<T>& r) const
+    {
+        size_t n = lev.diag.n_elem;
+        for (size_t i = 0; i < n; i++)
+        {
+            T Ax = lev.diag(i) * x(i);
+            if (i > 0)
+                Ax += lev.lower(i) * x(i-1);
+            if (i < n-1)
+                Ax += lev.upper(i) * x(i+1);
+            r(i) = b(i) - Ax;
+        }
+    }
+    
+    /* Gauss-Seidel goes forward before the coarse correction and backward
+     * after it, so that the cycle is symmetric */
+    void
+    smooth(level& lev, arma::Col<T>& x, const arma::Col<T>& b,
+           size_t sweeps, bool forward)
+    {
+        size_t n = lev.diag.n_elem;
+        
+        for (size_t s = 0; s < sweeps; s++)
+        {
+            if (m_smoother == multigrid_smoother::JACOBI)
+            {
+                arma::Col<T>& r = lev.work;
+                residual(lev, x, b, r);
+                for (size_t i = 0; i < n; i++)
+                    x(i) += m_jacobi_damping * r(i) / lev.diag(i);
+                continue;
+            }
+            
+            for (size_t k = 0; k < n; k++)
+            {
+                size_t i = forward ? k : n-1-k;
+                T s_i = b(i);
+                if (i > 0)
+                    s_i -= lev.lower(i) * x(i-1);
+                if (i < n-1)
+                    s_i -= lev.upper(i) * x(i+1);
+                x(i) = s_i / lev.diag(i);
+            }
+        }
+    }
+    
+    void
+    cycle(size_t l, arma::Col<T>& x, const arma::Col<T>& b)
+    {
+        level& lev = m_levels[l];
+        
+        if (l == m_levels.size()-1)
+        {
+            x = tridiagonal_solve(lev.lower, lev.diag, lev.upper, b);
+            return;
+        }
+        
+        level& coarse = m_levels[l+1];
+        
+        smooth(lev, x, b, m_pre_smooth, true);
+        
+        /* Restriction of the residual: transpose of the prolongation */
+        arma::Col<T>& r = lev.work;
+        residual(lev, x, b, r);
+        arma::Col<T>& rc = coarse.rhs;
+        rc.zeros();
+        for (size_t i = 0; i < r.n_elem; i++)
+        {
+            size_t c = lev.left[i];
+            if (c > 0)
+                rc(c-1) += lev.weight_left(i) * r(i);
+            if (c < rc.n_elem)
+                rc(c) += lev.weight_right(i) * r(i);
+        }
+        
+        /* Coarse correction: one recursive cycle for V, two for W */
+        arma::Col<T>& ec = coarse.correction;
+        ec.zeros();
+        size_t gamma = (m_cycle == multigrid_cycle::W) ? 2 : 1;
+        for (size_t g = 0; g < gamma; g++)
+            cycle(l+1, ec, rc);
+        
+        for (size_t i = 0; i < x.n_elem; i++)
+        {
+            size_t c = lev.left[i];
+            if (c > 0)
+                x(i) += lev.weight_left(i) * ec(c-1);
+            if (c < ec.n_elem)
+                x(i) += lev.weight_right(i) * ec(c);
+        }
+        
+        smooth(lev, x, b, m_post_smooth, false);
+    }
+    
+public:
+    face_multigrid(T x_min, T x_max,
+                   multigrid_cycle cyc = multigrid_cycle::V,
+                   multigrid_smoother smoother = multigrid_smoother::GAUSS_SEIDEL,
+                   size_t pre_smooth = 2, size_t post_smooth = 2)
+        : m_x_min(x_min), m_x_max(x_max), m_cycle(cyc), m_smoother(smoother),
+          m_pre_smooth(pre_smooth), m_post_smooth(post_smooth),
+          m_jacobi_damping(2./3.)
+    {}
+    
+    /* Add the next coarser level. faces are the coordinates of its interior
+     * faces, in increasing order. */
+    void
+    add_level(const arma::Col<T>& lower, const arma::Col<T>& diag,
+              const arma::Col<T>& upper, const arma::Col<T>& faces)
+    {
+        assert(diag.n_elem == faces.n_elem);
+        
+        level lev;
+        lev.lower = lower;
+        lev.diag = diag;
+        lev.upper = upper;
+        lev.faces = faces;
+        lev.work.set_size(diag.n_elem);
+        lev.rhs.set_size(diag.n_elem);
+        lev.correction.set_size(diag.n_elem);
+        
+        if (not m_levels.empty())
+        {
+            /* Prolongation from the new level to the previous one */
+            level& fine = m_levels.back();
+            size_t n = fine.faces.n_elem;
+            fine.left.resize(n);
+            fine.weight_left.set_size(n);
+            fine.weight_right.set_size(n);
+            
+            size_t c = 0;
+            for (size_t i = 0; i < n; i++)
+            {
+                T x = fine.faces(i);
+                while (c < faces.n_elem and faces(c) <= x)
+                    c++;
+                
+                T xl = (c == 0) ? m_x_min : faces(c-1);
+                T xr = (c == faces.n_elem) ? m_x_max : faces(c);
+                fine.left[i] = c;
+                fine.weight_right(i) = (x - xl)/(xr - xl);
+                fine.weight_left(i) = 1 - fine.weight_right(i);
+            }
+        }
+        
+        m_levels.push_back(lev);
+    }
+    
+    size_t
+    num_levels() const
+    {
+        return m_levels.size();
+    }
+    
+    /* Repeat cycles until the relative residual is below ctl.eps. The
+     * residual cannot go below round-off, which grows with the condition
+     * number of the system (about N^2): on large meshes eps may be out of
+     * reach, so the cycles stop also when one of them does not reduce the
+     * residual at all. A cycle which reduces it, even slowly, is never cut
+     * off: only ctl.maxit limits it. ctl.maxit = 0 means 100 cycles. */
+    arma::Col<T>
+    solve(const arma::Col<T>& b, const solver_control<T>& ctl, solver_info<T>& info)
+    {
+        assert(not m_levels.empty());
+        assert(b.n_elem == m_levels[0].diag.n_elem);
+        
+        solver_stopwatch sw;
+        info = solver_info<T>();
+        
+        T eps = ctl.eps;
+        size_t maxit = (ctl.maxit == 0) ? 100 : ctl.maxit;
+        
+        if (ctl.log)
+        {
+            *ctl.log << "Starting multigrid, " << m_levels.size() << " levels. ";
+            *ctl.log << "Target rr = " << eps << ", maxit = " << maxit << std::endl;
+        }
+        
+        arma::Col<T> x(b.n_elem);
+        x.zeros();
+        
+        T res0 = norm(b);
+        T res = res0;
+        solver_record(ctl, info, 0, res/res0);
+        
+        size_t iter = 0;
+        bool stagnated = false;
+        while ( (res/res0 > eps) and (iter++ < maxit) )
+        {
+            cycle(0, x, b);
+            T prev_res = res;
+            residual(m_levels[0], x, b, m_levels[0].work);
+            res = norm(m_levels[0].work);
+            solver_record(ctl, info, iter, res/res0);
+            
+            if (res >= prev_res)
+            {
+                stagnated = true;
+                break;
+            }
+        }
+        
+        info.iterations = std::min(iter, maxit);
+        info.relative_residual = res/res0;
+        info.converged = (iter <= maxit) and (res/res0 < eps);
+        sw.lap(info.total_time);
+        
+        if (stagnated and not info.converged)
+        {
+            if (ctl.log)
+            {
+                *ctl.log << "Solver stagnated, no decrease of the residual after " << iter;
+                *ctl.log << " cycles, ||r||/||r0|| = " << res/res0;
+                *ctl.log << std::endl;
+            }
+        }
+        else
+            solver_log_result(ctl, info, "cycles");
+        
+        return x;
+    }
+    
+    arma::Col<T>
+    solve(const arma::Col<T>& b, T eps = 1e-8, size_t maxit = 100)
+    {
+        solver_info<T> info;
+        return solve(b, solver_control<T>(eps, maxit), info);
+    }
+};
+
+/* Mesh with about half the elements of mesh, each coarse element being the
+ * union of two consecutive ones. If the number of elements is odd the last
+ * coarse element takes three. The faces of the coarse mesh are faces of the
+ * fine one, as the multigrid solver needs. */
+template<typename T>
+std::vector<element<T>>
+coarsen_mesh(const std::vector<element<T>>& mesh)
+{
+    std::vector<element<T>> coarse;
+    coarse.reserve(mesh.size()/2);
+    for (size_t i = 0; i+1 < mesh.size(); i += 2)
+    {
+        size_t last = (i+3 == mesh.size()) ? i+2 : i+1;
+        coarse.push_back( element<T>(mesh[i].points()[0], mesh[last].points()[1]) );
+    }
+    
+    return coarse;
+}
+
+/* Coordinates of the interior faces of mesh */
+template<typename T>
+arma::Col<T>
+interior_faces(const std::vector<element<T>>& mesh)
+{
+    arma::Col<T> faces(mesh.size()-1);
+    for (size_t i = 0; i+1 < mesh.size(); i++)
+        faces(i) = mesh[i].points()[1];
+    
+    return faces;
+}
+
+/* Sum the condensed matrix AC of element elem_num into the diagonals of the
+ * system on the interior faces. The boundary faces carry homogeneous
+ * Dirichlet conditions, so their rows and columns are simply dropped.
+ * Interior face f is unknown f-1. */
+template<typename T>
+void
+add_to_interior_system(size_t elem_num, size_t num_faces, const arma::Mat<T>& AC,
+                       arma::Col<T>& lower, arma::Col<T>& diag, arma::Col<T>& upper)
+{
+    for (size_t i = 0; i < AC.n_rows; i++)
+    {
+        size_t fi = elem_num+i;
+        if (fi == 0 or fi == num_faces-1)
+            continue;
+        
+        for (size_t j = 0; j < AC.n_cols; j++)
+        {
+            size_t fj = elem_num+j;
+            if (fj == 0 or fj == num_faces-1)
+                continue;
+            
+            if (fj == fi)
+                diag(fi-1) += AC(i,j);
+            else if (fj > fi)
+                upper(fi-1) += AC(i,j);
+            else
+                lower(fi-1) += AC(i,j);
+        }
+    }
+}
+
+/* Assemble the matrix of the condensed face system of mesh, on the interior
+ * faces, without the load. It is used for the coarse levels of the
+ * multigrid solver. The cache is used if rp.cache_operators is set. */
+template<typename T, typename Family>
+void
+assemble_interior_system(const run_parameters& rp, const std::vector<element<T>>& mesh,
+                         const local_operator_cache<T, Family>& cache,
+                         arma::Col<T>& lower, arma::Col<T>& diag, arma::Col<T>& upper)
+{
+    size_t num_faces = mesh.size() + 1;
+    size_t cs = rp.degree + 1;
+    
+    lower.zeros(num_faces-2);
+    diag.zeros(num_faces-2);
+    upper.zeros(num_faces-2);
+    
+    hho_local_operator<T, Family> lop;
+    if (not rp.cache_operators)
+        lop = hho_local_operator<T, Family>(rp.degree);
+    
+    for (size_t elem_num = 0; elem_num < mesh.size(); elem_num++)
+    {
+        auto& elem = mesh[elem_num];
+        
+        arma::Mat<T> AC;
+        if (rp.cache_operators)
+            AC = cache.condensed_matrix(elem);
+        else
+        {
+            lop.build(elem);
+            const arma::Mat<T>& LC = lop.local_contrib();
+            
+            arma::Mat<T> K_TT = LC.submat(0, 0, arma::size(cs, cs));
+            arma::Mat<T> K_TF = LC.submat(0, cs, arma::size(cs, 2));
+            arma::Mat<T> K_FT = LC.submat(cs, 0, arma::size(2, cs));
+            arma::Mat<T> K_FF = LC.submat(cs, cs, arma::size(2, 2));
+            
+            AC = K_FF - K_FT * spd_solver<T>(K_TT).solve(K_TF);
+        }
+        
+        add_to_interior_system(elem_num, num_faces, AC, lower, diag, upper);
+    }
+}
@@ -0,0 +1,74 @@
+/*
+ *       /\
+ *      /__\        Matteo Cicuttin (C) 2016 - matteo.cicuttin@enpc.fr
+ *     /_\/_\
+ *    /\    /\      École Nationale des Ponts et Chaussées
+ *   /__\  /__\     CERMICS
+ *  /_\/_\/_\/_\
+ *
+ * This is a simple 1D code for the demonstration of the Hybrid High Order
+ * numerical method. It is intended only to show the details of all the
+ * involved operators (projection, gradient reconstruction, stabilization)
+ * step by step.
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+/* Split [0, num_items) in num_threads contiguous chunks and call
+ * fn(thread_id, begin, end) on each of them, each chunk on its own thread.
+ * All the chunks but the last start and end at multiples of grain, so that
+ * fn can process the items by blocks of grain aligned to the global indices.
+ * With a single thread fn is called directly on the calling thread.
+ *
+ * Results written at per-item positions are the same for any thread count
+ * provided that fn computes each item in the same way whatever the chunk it
+ * is in. If fn treats the items by blocks, this holds only if the blocks are
+ * aligned to multiples of grain and the items after the last full block of
+ * the whole range are the only ones treated apart.
+ */
+template<typename Function>
+void
+parallel_for_chunks(size_t num_items, size_t num_threads, const Function& fn,
+                    size_t grain = 1)
+{
+    grain = std::max(grain, size_t(1));
+    size_t num_blocks = (num_items + grain - 1) / grain;
+    num_threads = std::max(std::min(num_threads, num_blocks), size_t(1));
+    
+    if (num_threads == 1)
+    {
+        fn(size_t(0), size_t(0), num_items);
+        return;
+    }
+    
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads);
+    
+    for (size_t tid = 0; tid < num_threads; tid++)
+    {
+        size_t begin = std::min(grain * ((num_blocks * tid) / num_threads), num_items);
+        size_t end = std::min(grain * ((num_blocks * (tid+1)) / num_threads), num_items);
+        threads.push_back( std::thread(fn, tid, begin, end) );
+    }
+    
+    for (auto& thread : threads)
+        thread.join();
+}
@@ -0,0 +1,253 @@
+/*
+ *       /\
+ *      /__\        Matteo Cicuttin (C) 2016 - matteo.cicuttin@enpc.fr
+ *     /_\/_\
+ *    /\    /\      École Nationale des Ponts et Chaussées
+ *   /__\  /__\     CERMICS
+ *  /_\/_\/_\/_\
+ *
+ * This is a simple 1D code for the demonstration of the Hybrid High Order
+ * numerical method. It is intended only to show the details of all the
+ * involved operators (projection, gradient reconstruction, stabilization)
+ * step by step.
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <armadillo>
+#include <vector>
+#include <cmath>
+#include <cassert>
+
+/* Preconditioners for conjugate_gradient. Each one is built from the system
+ * matrix, which must be SPD, and apply(r) returns z = M^-1 r. The matrix is
+ * read directly in its compressed sparse column storage. */
+
+/* No preconditioning, z = r */
+template<typename T>
+class identity_preconditioner
+{
+public:
+    identity_preconditioner()
+    {}
+    
+    identity_preconditioner(const arma::SpMat<T>&)
+    {}
+    
+    arma::Col<T>
+    apply(const arma::Col<T>& r) const
+    {
+        return r;
+    }
+};
+
+/* Diagonal (Jacobi) preconditioner, M = D */
+template<typename T>
+class jacobi_preconditioner
+{
+    arma::Col<T>    m_inv_diag;
+    
+public:
+    jacobi_preconditioner(const arma::SpMat<T>& A)
+    {
+        m_inv_diag = A.diag();
+        for (auto& d : m_inv_diag)
+        {
+            assert(d > 0);
+            d = T(1)/d;
+        }
+    }
+    
+    arma::Col<T>
+    apply(const arma::Col<T>& r) const
+    {
+        return r % m_inv_diag;
+    }
+};
+
+/* Symmetric SOR preconditioner,
+ *
+ *   M = 1/(omega (2-omega)) (D + omega L) D^-1 (D + omega L^T),
+ *
+ * with L the strictly lower triangular part of A. Both the triangular solves
+ * go through A by columns, so they are done on a copy of its CSC arrays.
+ */
+template<typename T>
+class ssor_preconditioner
+{
+    size_t                  m_size;
+    std::vector<size_t>     m_col_ptrs, m_row_indices;
+    std::vector<T>          m_values;
+    arma::Col<T>            m_diag;
+    T                       m_omega;
+    
+public:
+    ssor_preconditioner(const arma::SpMat<T>& A, T omega = 1.0)
+        : m_size(A.n_cols), m_omega(omega)
+    {
+        assert(A.n_rows == A.n_cols);
+        assert(omega > 0 and omega < 2);
+        
+        m_col_ptrs.assign(A.col_ptrs, A.col_ptrs + m_size + 1);
+        m_row_indices.assign(A.row_indices, A.row_indices + A.n_nonzero);
+        m_values.assign(A.values, A.values + A.n_nonzero);
+        m_diag = A.diag();
+    }
+    
+    arma::Col<T>
+    apply(const arma::Col<T>& r) const
+    {
+        arma::Col<T> z = r;
+        
+        /* Forward solve with (D + omega L), by columns */
+        for (size_t j = 0; j < m_size; j++)
+        {
+            z(j) /= m_diag(j);
+            for (size_t p = m_col_ptrs[j]; p < m_col_ptrs[j+1]; p++)
+                if (m_row_indices[p] > j)
+                    z(m_row_indices[p]) -= m_omega * m_values[p] * z(j);
+        }
+        
+        /* Multiply by D */
+        z %= m_diag;
+        
+        /* Backward solve with (D + omega L^T) = (D + omega U), by columns */
+        for (size_t j = m_size; j-- > 0; )
+        {
+            z(j) /= m_diag(j);
+            for (size_t p = m_col_ptrs[j]; p < m_col_ptrs[j+1]; p++)
+                if (m_row_indices[p] < j)
+                    z(m_row_indices[p]) -= m_omega * m_values[p] * z(j);
+        }
+        
+        return z * (m_omega * (2 - m_omega));
+    }
+};
+
+/* Incomplete Cholesky without fill-in, IC(0): A ~ L L^T, where L has the
+ * sparsity pattern of the lower triangular part of A. The face system of the
+ * diffusion problem is tridiagonal, so there is no fill-in to drop and this
+ * is the exact factorization. If a pivot is not positive the factorization
+ * breaks down; the pivot is then replaced by the diagonal of A.
+ */
+template<typename T>
+class incomplete_cholesky_preconditioner
+{
+    size_t                  m_size;
+    std::vector<size_t>     m_col_ptrs, m_row_indices;  /* L, by columns */
+    std::vector<T>          m_values;                   /* diagonal first */
+    
+    /* Position of L(i,j) in m_values, or m_values.size() if it is not in the
+     * pattern */
+    size_t
+    position(size_t i, size_t j) const
+    {
+        for (size_t p = m_col_ptrs[j]; p < m_col_ptrs[j+1]; p++)
+            if (m_row_indices[p] == i)
+                return p;
+        
+        return m_values.size();
+    }
+    
+public:
+    incomplete_cholesky_preconditioner(const arma::SpMat<T>& A)
+        : m_size(A.n_cols)
+    {
+        assert(A.n_rows == A.n_cols);
+        
+        /* Copy the lower triangle of A, with the diagonal entry first in
+         * each column */
+        m_col_ptrs.push_back(0);
+        for (size_t j = 0; j < m_size; j++)
+        {
+            m_row_indices.push_back(j);
+            m_values.push_back(0);
+            size_t diag_pos = m_values.size() - 1;
+            
+            for (size_t p = A.col_ptrs[j]; p < A.col_ptrs[j+1]; p++)
+            {
+                size_t i = A.row_indices[p];
+                if (i == j)
+                    m_values[diag_pos] = A.values[p];
+                else if (i > j)
+                {
+                    m_row_indices.push_back(i);
+                    m_values.push_back(A.values[p]);
+                }
+            }
+            m_col_ptrs.push_back(m_values.size());
+        }
+        
+        /* Right-looking factorization, restricted to the pattern */
+        for (size_t k = 0; k < m_size; k++)
+        {
+            size_t kk = m_col_ptrs[k];
+            T pivot = m_values[kk];
+            if (pivot <= 0)
+                pivot = A(k,k);
+            
+            T lkk = std::sqrt(pivot);
+            m_values[kk] = lkk;
+            
+            for (size_t p = kk+1; p < m_col_ptrs[k+1]; p++)
+                m_values[p] /= lkk;
+            
+            /* Update the columns j > k that are coupled with k */
+            for (size_t p = kk+1; p < m_col_ptrs[k+1]; p++)
+            {
+                size_t j = m_row_indices[p];
+                T ljk = m_values[p];
+                
+                for (size_t q = kk+1; q < m_col_ptrs[k+1]; q++)
+                {
+                    size_t i = m_row_indices[q];
+                    if (i < j)
+                        continue;
+                    
+                    size_t pos = position(i, j);
+                    if (pos < m_values.size())
+                        m_values[pos] -= m_values[q] * ljk;
+                }
+            }
+        }
+    }
+    
+    arma::Col<T>
+    apply(const arma::Col<T>& r) const
+    {
+        arma::Col<T> z = r;
+        
+        /* Forward solve with L, by columns */
+        for (size_t j = 0; j < m_size; j++)
+        {
+            z(j) /= m_values[m_col_ptrs[j]];
+            for (size_t p = m_col_ptrs[j]+1; p < m_col_ptrs[j+1]; p++)
+                z(m_row_indices[p]) -= m_values[p] * z(j);
+        }
+        
+        /* Backward solve with L^T: row j of L^T is column j of L */
+        for (size_t j = m_size; j-- > 0; )
+        {
+            T s = z(j);
+            for (size_t p = m_col_ptrs[j]+1; p < m_col_ptrs[j+1]; p++)
+                s -= m_values[p] * z(m_row_indices[p]);
+            z(j) = s / m_values[m_col_ptrs[j]];
+        }
+        
+        return z;
+    }
+};
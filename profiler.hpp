@@ -0,0 +1,337 @@
+/*
+ *       /\
+ *      /__\        Matteo Cicuttin (C) 2016 - matteo.cicuttin@enpc.fr
+ *     /_\/_\
+ *    /\    /\      École Nationale des Ponts et Chaussées
+ *   /__\  /__\     CERMICS
+ *  /_\/_\/_\/_\
+ *
+ * This is a simple 1D code for the demonstration of the Hybrid High Order
+ * numerical method. It is intended only to show the details of all the
+ * involved operators (projection, gradient reconstruction, stabilization)
+ * step by step.
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+
+/* Timers and counters of the phases of the examples, for --profile.
+ *
+ * PROFILE_SCOPE(name) times the rest of the enclosing block, and
+ * PROFILE_COUNT(name, n) adds n to a counter. PROFILE_SCOPE_DETAIL(name) is
+ * a PROFILE_SCOPE for the small operations repeated on each element: the
+ * clock reads are not negligible there, so it records only if the details
+ * are enabled too. They do something only if the code is compiled with
+ * HHO_PROFILING (the PROFILING option of CMake), otherwise they are empty.
+ * When compiled in, they record only after profiler::instance().enable(),
+ * and they cost a load and a branch before that. They can be used from
+ * several threads at once.
+ *
+ * The names are paths, "solve/condensation" being a phase of "solve": the
+ * summary indents them accordingly. Phases are listed in the order they are
+ * first reached. A phase timed inside several threads sums their times, so
+ * it can take longer than the phase that contains it.
+ */
+
+struct profile_entry
+{
+    std::string             name;
+    bool                    timed;
+    bool                    detail;
+    std::atomic<uint64_t>   calls;
+    std::atomic<uint64_t>   nanoseconds;
+    
+    profile_entry(const std::string& p_name, bool p_timed, bool p_detail)
+        : name(p_name), timed(p_timed), detail(p_detail), calls(0), nanoseconds(0)
+    {}
+};
+
+class profiler
+{
+    std::deque<profile_entry>   m_entries;  /* a deque does not move them */
+    std::mutex                  m_mutex;
+    std::atomic<bool>           m_enabled, m_detailed;
+    
+    profiler()
+        : m_enabled(false), m_detailed(false)
+    {}
+    
+    static size_t
+    depth(const std::string& name)
+    {
+        size_t d = 0;
+        for (auto c : name)
+            if (c == '/')
+                d++;
+        return d;
+    }
+    
+    static std::string
+    leaf(const std::string& name)
+    {
+        auto pos = name.rfind('/');
+        return (pos == std::string::npos) ? name : name.substr(pos+1);
+    }
+    
+public:
+    typedef std::vector<std::pair<std::string, std::string>>    metadata_type;
+    
+    static profiler&
+    instance()
+    {
+        static profiler p;
+        return p;
+    }
+    
+    /* The per-element timers slow down the phases they are in, so they
+     * are off unless asked for */
+    void
+    enable(bool e = true, bool detailed = false)
+    {
+        m_enabled.store(e, std::memory_order_relaxed);
+        m_detailed.store(detailed, std::memory_order_relaxed);
+    }
+    
+    bool
+    enabled() const
+    {
+        return m_enabled.load(std::memory_order_relaxed);
+    }
+    
+    bool
+    recording(const profile_entry& e) const
+    {
+        return enabled() and (not e.detail or m_detailed.load(std::memory_order_relaxed));
+    }
+    
+    profile_entry&
+    entry(const std::string& name, bool timed, bool detail = false)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& e : m_entries)
+            if (e.name == name)
+                return e;
+        
+        m_entries.emplace_back(name, timed, detail);
+        return m_entries.back();
+    }
+    
+    /* Zero all the timers and counters, for example between the repetitions
+     * of a benchmark */
+    void
+    reset()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& e : m_entries)
+        {
+            e.calls = 0;
+            e.nanoseconds = 0;
+        }
+    }
+    
+    /* Total time of a phase, 0 if it was never reached */
+    double
+    seconds(const std::string& name)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& e : m_entries)
+            if (e.name == name)
+                return e.nanoseconds * 1e-9;
+        
+        return 0;
+    }
+    
+    /* Table of the phases. The percentages are of the total time of the
+     * top level phases. */
+    void
+    print_summary(std::ostream& os)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        
+        double total = 0;
+        for (auto& e : m_entries)
+            if (e.timed and depth(e.name) == 0)
+                total += e.nanoseconds * 1e-9;
+        
+        os << "Profile:" << std::endl;
+        os << std::left << std::setw(40) << "  phase" << std::right
+           << std::setw(12) << "calls" << std::setw(16) << "total [ms]"
+           << std::setw(16) << "mean [us]" << std::setw(9) << "%" << std::endl;
+        
+        for (auto& e : m_entries)
+        {
+            if (e.calls == 0)
+                continue;
+            
+            std::string label = std::string(2*depth(e.name) + 2, ' ') + leaf(e.name);
+            os << std::left << std::setw(40) << label << std::right
+               << std::setw(12) << e.calls;
+            
+            if (e.timed)
+            {
+                double t = e.nanoseconds * 1e-9;
+                os << std::fixed << std::setprecision(3)
+                   << std::setw(16) << t*1e3
+                   << std::setw(16) << t*1e6/e.calls
+                   << std::setprecision(1)
+                   << std::setw(9) << (total > 0 ? 100*t/total : 0.0);
+                os.unsetf(std::ios::floatfield);
+                os << std::setprecision(6);
+            }
+            
+            os << std::endl;
+        }
+    }
+    
+    /* One line per phase. The metadata (the run parameters) are repeated
+     * on each line as the first columns, so that the files of several runs
+     * can be concatenated. */
+    void
+    write_csv(std::ostream& os, const metadata_type& metadata)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        
+        for (auto& md : metadata)
+            os << md.first << ",";
+        os << "phase,kind,calls,seconds" << std::endl;
+        
+        for (auto& e : m_entries)
+        {
+            for (auto& md : metadata)
+                os << md.second << ",";
+            os << e.name << "," << (e.timed ? "timer" : "counter") << ","
+               << e.calls << "," << std::setprecision(9) << e.nanoseconds * 1e-9
+               << std::setprecision(6) << std::endl;
+        }
+    }
+    
+    void
+    write_json(std::ostream& os, const metadata_type& metadata)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        
+        os << "{" << std::endl << "  \"parameters\": {";
+        for (size_t i = 0; i < metadata.size(); i++)
+        {
+            os << (i == 0 ? "" : ",") << std::endl;
+            os << "    \"" << metadata[i].first << "\": \"" << metadata[i].second << "\"";
+        }
+        os << std::endl << "  }," << std::endl << "  \"phases\": [";
+        
+        for (size_t i = 0; i < m_entries.size(); i++)
+        {
+            auto& e = m_entries[i];
+            os << (i == 0 ? "" : ",") << std::endl;
+            os << "    { \"phase\": \"" << e.name << "\", \"kind\": \""
+               << (e.timed ? "timer" : "counter") << "\", \"calls\": " << e.calls
+               << ", \"seconds\": " << std::setprecision(9) << e.nanoseconds * 1e-9
+               << std::setprecision(6) << " }";
+        }
+        os << std::endl << "  ]" << std::endl << "}" << std::endl;
+    }
+    
+    /* JSON if filename ends with .json, CSV otherwise */
+    bool
+    dump(const std::string& filename, const metadata_type& metadata)
+    {
+        std::ofstream ofs(filename);
+        if (not ofs.is_open())
+            return false;
+        
+        std::string ext = ".json";
+        bool json = filename.size() >= ext.size() and
+                    filename.compare(filename.size()-ext.size(), ext.size(), ext) == 0;
+        
+        if (json)
+            write_json(ofs, metadata);
+        else
+            write_csv(ofs, metadata);
+        
+        return ofs.good();
+    }
+};
+
+class scoped_timer
+{
+    using clock = std::chrono::steady_clock;
+    
+    profile_entry       *m_entry;
+    clock::time_point   m_start;
+    
+public:
+    explicit scoped_timer(profile_entry& entry)
+        : m_entry(profiler::instance().recording(entry) ? &entry : nullptr)
+    {
+        if (m_entry)
+            m_start = clock::now();
+    }
+    
+    scoped_timer(const scoped_timer&) = delete;
+    scoped_timer& operator=(const scoped_timer&) = delete;
+    
+    ~scoped_timer()
+    {
+        if (not m_entry)
+            return;
+        
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - m_start);
+        m_entry->calls.fetch_add(1, std::memory_order_relaxed);
+        m_entry->nanoseconds.fetch_add(ns.count(), std::memory_order_relaxed);
+    }
+};
+
+#ifdef HHO_PROFILING
+
+#define HHO_PROFILE_CONCAT_(a, b)   a##b
+#define HHO_PROFILE_CONCAT(a, b)    HHO_PROFILE_CONCAT_(a, b)
+
+/* The entry is looked up once per call site, the first time it is reached */
+#define HHO_PROFILE_SCOPE(name, detail)                                         \
+    static profile_entry& HHO_PROFILE_CONCAT(hho_profile_entry_, __LINE__) =    \
+        profiler::instance().entry(name, true, detail);                         \
+    scoped_timer HHO_PROFILE_CONCAT(hho_profile_timer_, __LINE__)               \
+        (HHO_PROFILE_CONCAT(hho_profile_entry_, __LINE__))
+
+#define PROFILE_SCOPE(name)         HHO_PROFILE_SCOPE(name, false)
+#define PROFILE_SCOPE_DETAIL(name)  HHO_PROFILE_SCOPE(name, true)
+
+#define PROFILE_COUNT(name, n)                                                  \
+    do {                                                                        \
+        static profile_entry& hho_profile_counter =                             \
+            profiler::instance().entry(name, false);                            \
+        if (profiler::instance().enabled())                                     \
+            hho_profile_counter.calls.fetch_add(n, std::memory_order_relaxed);  \
+    } while (0)
+
+#else
+
+#define PROFILE_SCOPE(name)
+#define PROFILE_SCOPE_DETAIL(name)
+#define PROFILE_COUNT(name, n)      do {} while (0)
+
+#endif
@@ -28,99 +28,73 @@
 
 #pragma once
 
+#include <vector>
 #include <armadillo>
 
 #include "element.hpp"
 #include "basis.hpp"
+#include "basis_table.hpp"
+#include "moment_table.hpp"
+#include "local_solver.hpp"
 #include "quadrature.hpp"
 
-template<typename T>
+template<typename T, typename Family = scaled_monomials>
 class projector
 {
-    basis<T>        m_basis;
-    quadrature<T>   m_quad;
-    size_t          m_degree;
+    basis<T, Family>        m_basis;
+    quadrature<T>           m_quad;
+    basis_table<T, Family>  m_table;
+    moment_table<T, Family> m_moments;
+    size_t                  m_degree;
     
 public:
     projector()
-        : m_degree(1)
+        : m_basis(1), m_quad(2), m_table(m_basis, m_quad),
+          m_moments(m_basis.size()), m_degree(1)
     {}
     
     projector(size_t degree)
-        : m_degree(degree)
+        : m_basis(degree), m_quad(2*degree), m_table(m_basis, m_quad),
+          m_moments(m_basis.size()), m_degree(degree)
     {}
     
     template<typename Function>
     arma::Col<T>
     project(const element<T>& elem, const Function& f)
     {
-        m_basis = basis<T>(m_degree);
-        m_quad  = quadrature<T>(2*m_degree);
-     
-        arma::Mat<T>    mass_matrix(m_basis.size(), m_basis.size());
-        arma::Col<T>    rhs(m_basis.size());
+        arma::Mat<T>    mass_matrix = m_moments.mass_matrix(elem);
+        arma::Col<T>    rhs = this->rhs(elem, f);
         
-        mass_matrix.zeros();
-        rhs.zeros();
+        /* With an orthogonal basis the mass matrix is diagonal */
+        if (Family::orthogonal)
+            return rhs / mass_matrix.diag();
         
-        auto qd = m_quad.integrate(elem);
-        for (auto& qp : qd)
-        {
-            auto qpoint  = qp.first;
-            auto qweight = qp.second;
-            
-            auto phi = m_basis.eval_functions(elem, qpoint);
-            mass_matrix += qweight * phi * phi.t();
-            rhs += qweight * phi * f(qpoint);
-        }
-        
-        return solve(mass_matrix, rhs);
+        return spd_solver<T>(mass_matrix).solve(rhs);
     }
     
     template<typename Function>
     arma::Col<T>
     rhs(const element<T>& elem, const Function& f)
     {
-        m_basis = basis<T>(m_degree);
-        m_quad  = quadrature<T>(2*m_degree);
-        
-        arma::Col<T>    r_rhs(m_basis.size());
-        
-        r_rhs.zeros();
+        /* Weighted values of f at the nodes, then r = B^T (w f) */
+        arma::Col<T>    wf(m_table.num_points());
         
-        auto qd = m_quad.integrate(elem);
-        for (auto& qp : qd)
+        size_t iqp = 0;
+        for (auto qp : m_quad.map(elem))
         {
             auto qpoint  = qp.first;
             auto qweight = qp.second;
             
-            auto phi = m_basis.eval_functions(elem, qpoint);
-            r_rhs += qweight * phi * f(qpoint);
+            wf(iqp++) = qweight * f(qpoint);
         }
         
-        return r_rhs;
+        return m_table.function_matrix().t() * wf;
     }
     
     arma::Mat<T>
     as_matrix(const element<T>& elem)
     {
-        m_basis = basis<T>(m_degree);
-        m_quad  = quadrature<T>(2*m_degree);
-        
-        arma::Mat<T> mass_matrix(m_basis.size(), m_basis.size());
-        mass_matrix.zeros();
-        
-        auto qd = m_quad.integrate(elem);
-        for (auto& qp : qd)
-        {
-            auto qpoint  = qp.first;
-            auto qweight = qp.second;
-            
-            auto phi = m_basis.eval_functions(elem, qpoint);
-            mass_matrix += qweight * phi * phi.t();
-        }
-        
-        return mass_matrix;
+        return m_moments.mass_matrix(elem);
     }
     
     T
@@ -129,5 +103,13 @@ public:
         auto phi = m_basis.eval_functions(elem, point);
         return dot(phi, projection);
     }
+    
+    arma::Col<T>
+    eval_projection(const element<T>& elem, const arma::Col<T>& projection,
+                    const std::vector<T>& points)
+    {
+        arma::Mat<T> phi = m_basis.eval_functions(elem, points);
+        return phi * projection;
+    }
 };
 
@@ -46,7 +46,7 @@
  * In this example a function is projected onto the polynomial space P^k.
  */
 
-template<typename T>
+template<typename T, typename Family = scaled_monomials>
 static int
 run_example_projection(const run_parameters& rp)
 {
@@ -63,25 +63,26 @@ run_example_projection(const run_parameters& rp)
     arma::Col<T> y_val(rp.num_elements * rp.eval_per_elem);
     size_t pos = 0;
     
+    projector<T, Family> proj(rp.degree);
+    
+    auto pf = [](T p) -> T {
+        return sin(3.141592*p);
+    };
+    
     for (auto& elem : mesh)
     {
         /* Compute projection on current element */
-        projector<T> proj(rp.degree);
-        
-        auto pf = [](T p) -> T {
-            return sin(3.141592*p);
-        };
-        
         auto x = proj.project(elem, pf);
         
         /* Compute some test points inside the element */
         auto tps = make_test_points(elem, rp.eval_per_elem);
         
         /* Postprocess: recover the solution on the test points */
+        auto vals = proj.eval_projection(elem, x, tps);
         for (size_t j = 0; j < rp.eval_per_elem; j++)
         {
             x_val(pos) = tps[j];
-            y_val(pos) = proj.eval_projection(elem, x, tps[j]);
+            y_val(pos) = vals(j);
             pos++;
         }
     }
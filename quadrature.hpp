@@ -31,54 +31,158 @@
 #include <vector>
 #include <utility>
 #include <algorithm>
+#include <iterator>
+#include <map>
+#include <mutex>
+
+#include <armadillo>
 
 #include "element.hpp"
 
+/* Reference Gauss-Legendre rules on [-1, 1]. The rules depend only on the
+ * scalar type and on the number of points, so they are computed once with the
+ * Golub-Welsch algorithm and then shared by all the quadrature objects. The
+ * registry is process-wide and protected by a mutex; the returned reference
+ * stays valid for the whole lifetime of the program.
+ */
 template<typename T>
-class quadrature
+const std::vector<std::pair<T,T>>&
+gauss_legendre_rule(size_t num_points)
 {
-    std::vector<std::pair<T,T>>     m_quadrature_data;
-    size_t                          m_order;
+    static std::map<size_t, std::vector<std::pair<T,T>>>    rules;
+    static std::mutex                                       rules_mutex;
     
-    void
-    compute(size_t order)
+    std::lock_guard<std::mutex> lock(rules_mutex);
+    
+    auto itor = rules.find(num_points);
+    if (itor != rules.end())
+        return (*itor).second;
+    
+    std::vector<std::pair<T,T>> qdata;
+    
+    if (num_points == 1)
     {
-        size_t num_points;
+        qdata.push_back( std::make_pair( 0., 2.) );
+        return (*rules.emplace(num_points, std::move(qdata)).first).second;
+    }
+    
+    arma::Col<T> vals(num_points-1);
+    for (size_t i = 0; i < vals.size(); i++)
+        vals(i) = std::sqrt( 1. / ( 4. - 1. / ((i+1)*(i+1)) ) );
+    
+    arma::Mat<T> M(num_points, num_points);
+    M.zeros();
+    M.diag(-1) = vals;
+    M.diag(+1) = vals;
+    
+    arma::Mat<T> eigvec;
+    arma::Col<T> eigval;
+    eig_sym(eigval, eigvec, M);
+    
+    arma::Row<T> weights = eigvec.row(0);
+    
+    qdata.reserve(num_points);
+    for (size_t i = 0; i < num_points; i++)
+    {
+        auto qd = std::make_pair(eigval(i), 2*weights(i)*weights(i));
+        qdata.push_back( qd );
+    }
+    
+    return (*rules.emplace(num_points, std::move(qdata)).first).second;
+}
+
+/* Lightweight view over a reference rule which maps points and weights to a
+ * specific element on the fly. It does not own nor allocate anything, so it
+ * can be used in the element loops at no cost.
+ */
+template<typename T>
+class mapped_quadrature
+{
+    typedef typename std::vector<std::pair<T,T>>::const_iterator    ref_iterator;
+    
+    ref_iterator    m_begin, m_end;
+    T               m_h, m_x0;
+    
+public:
+    class iterator
+    {
+        ref_iterator    m_itor;
+        T               m_h, m_x0;
         
-        if (order%2 == 0)
-            order++;
+    public:
+        /* The mapped points are computed on dereference and returned by
+         * value, so this is only an input iterator and it has no operator->.
+         * `pointer` is void but must be declared, otherwise iterator_traits
+         * is empty and the range constructors of the containers reject it.
+         */
+        typedef std::input_iterator_tag     iterator_category;
+        typedef std::pair<T,T>              value_type;
+        typedef std::ptrdiff_t              difference_type;
+        typedef void                        pointer;
+        typedef std::pair<T,T>              reference;
         
-        num_points = std::max( ((order%2 == 0) ? order+1 : order+2)/2, size_t(1));
+        iterator(ref_iterator itor, T h, T x0)
+            : m_itor(itor), m_h(h), m_x0(x0)
+        {}
         
-        if (num_points == 1)
+        std::pair<T,T>
+        operator*() const
         {
-            m_quadrature_data.push_back( std::make_pair( 0., 1.) );
-            return;
+            auto pt = ((*m_itor).first+1)*0.5*m_h + m_x0;
+            auto w = (*m_itor).second * 0.5 * m_h;
+            return std::make_pair(pt, w);
         }
         
-        arma::Col<T> vals(num_points-1);
-        for (size_t i = 0; i < vals.size(); i++)
-            vals(i) = std::sqrt( 1. / ( 4. - 1. / ((i+1)*(i+1)) ) );
+        iterator&
+        operator++()
+        {
+            ++m_itor;
+            return *this;
+        }
         
-        arma::Mat<T> M(num_points, num_points);
-        M.zeros();
-        M.diag(-1) = vals;
-        M.diag(+1) = vals;
+        iterator
+        operator++(int)
+        {
+            auto ret = *this;
+            ++m_itor;
+            return ret;
+        }
         
-        arma::Mat<T> eigvec;
-        arma::Col<T> eigval;
-        eig_sym(eigval, eigvec, M);
+        bool operator==(const iterator& other) const { return m_itor == other.m_itor; }
+        bool operator!=(const iterator& other) const { return m_itor != other.m_itor; }
+    };
+    
+    mapped_quadrature(const std::vector<std::pair<T,T>>& rule, const element<T>& elem)
+        : m_begin(rule.begin()), m_end(rule.end()),
+          m_h(elem.measure()), m_x0(elem.points()[0])
+    {}
+    
+    iterator begin() const { return iterator(m_begin, m_h, m_x0); }
+    iterator end() const { return iterator(m_end, m_h, m_x0); }
+    
+    size_t size() const
+    {
+        return std::distance(m_begin, m_end);
+    }
+};
+
+template<typename T>
+class quadrature
+{
+    const std::vector<std::pair<T,T>>*  m_quadrature_data;
+    size_t                              m_order;
+    
+    void
+    compute(size_t order)
+    {
+        size_t num_points;
         
-        arma::Row<T> weights = eigvec.row(0);
+        if (order%2 == 0)
+            order++;
         
-        m_quadrature_data.clear();
-        m_quadrature_data.reserve(num_points);
+        num_points = std::max( ((order%2 == 0) ? order+1 : order+2)/2, size_t(1));
         
-        for (size_t i = 0; i < num_points; i++)
-        {
-            auto qd = std::make_pair(eigval(i), weights(i)*weights(i));
-            m_quadrature_data.push_back( qd );
-        }
+        m_quadrature_data = &gauss_legendre_rule<T>(num_points);
     }
     
 public:
@@ -94,28 +198,19 @@ public:
         compute(m_order);
     }
     
+    /* Map the rule on the element without allocating: use this one in the
+     * element loops, as in `for (auto qp : quad.map(elem))`.
+     */
+    mapped_quadrature<T>
+    map(const element<T>& elem) const
+    {
+        return mapped_quadrature<T>(*m_quadrature_data, elem);
+    }
+    
     std::vector<std::pair<T,T>>
-    integrate(const element<T>& elem)
+    integrate(const element<T>& elem) const
     {
-        std::vector<std::pair<T,T>> ret;
-        ret.resize( m_quadrature_data.size() );
-        
-        auto h = elem.measure();
-        auto pts = elem.points();
-        
-        auto tf = [&](const std::pair<T,T>& qd) -> std::pair<T,T> {
-            auto pt = (qd.first+1)*0.5*h + pts[0];
-            auto w = qd.second * h;
-            return std::make_pair(pt, w);
-        };
-        
-        std::transform(m_quadrature_data.begin(), m_quadrature_data.end(),
-                       ret.begin(), tf);
-        
-        return ret;
+        auto mq = map(elem);
+        return std::vector<std::pair<T,T>>(mq.begin(), mq.end());
     }
 };
-
-
-
-
@@ -0,0 +1,142 @@
+/*
+ *       /\
+ *      /__\        Matteo Cicuttin (C) 2016 - matteo.cicuttin@enpc.fr
+ *     /_\/_\
+ *    /\    /\      École Nationale des Ponts et Chaussées
+ *   /__\  /__\     CERMICS
+ *  /_\/_\/_\/_\
+ *
+ * This is a simple 1D code for the demonstration of the Hybrid High Order
+ * numerical method. It is intended only to show the details of all the
+ * involved operators (projection, gradient reconstruction, stabilization)
+ * step by step.
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <functional>
+
+/* Parameters of the iterative solvers (CG and multigrid).
+ *
+ *  - eps, maxit: the iterations stop when the relative residual is below
+ *    eps, or after maxit iterations.
+ *  - log: where the solver writes its progress messages; nullptr to write
+ *    nothing, as in batch runs.
+ *  - keep_history: store the relative residual of each iteration in the
+ *    solver_info.
+ *  - monitor: if set, called after each iteration with the number of the
+ *    iteration and the relative residual.
+ */
+template<typename T>
+struct solver_control
+{
+    T                               eps;
+    size_t                          maxit;
+    std::ostream                    *log;
+    bool                            keep_history;
+    std::function<void(size_t, T)>  monitor;
+    
+    explicit solver_control(T p_eps = 1e-8, size_t p_maxit = 0)
+        : eps(p_eps), maxit(p_maxit), log(&std::cout), keep_history(false)
+    {}
+};
+
+/* What an iterative solver reports about a solve. The times are in seconds
+ * and are split between the products by the matrix, the applications of the
+ * preconditioner and the vector operations; the multigrid fills only
+ * total_time. The residual history starts with the initial residual, so it
+ * has iterations+1 entries. */
+template<typename T>
+struct solver_info
+{
+    size_t          iterations;
+    T               relative_residual;
+    bool            converged;
+    std::vector<T>  residual_history;
+    double          spmv_time, precond_time, vector_time, total_time;
+    
+    solver_info()
+        : iterations(0), relative_residual(0), converged(false),
+          spmv_time(0), precond_time(0), vector_time(0), total_time(0)
+    {}
+};
+
+/* Accumulates into a counter of seconds the time elapsed between two calls
+ * of lap(). Used by the solvers to split their time among their phases. */
+class solver_stopwatch
+{
+    using clock = std::chrono::steady_clock;
+    clock::time_point   m_last;
+    
+public:
+    solver_stopwatch()
+        : m_last(clock::now())
+    {}
+    
+    void
+    lap(double& counter)
+    {
+        clock::time_point now = clock::now();
+        counter += std::chrono::duration<double>(now - m_last).count();
+        m_last = now;
+    }
+};
+
+/* Record the residual of one iteration as asked by ctl */
+template<typename T>
+void
+solver_record(const solver_control<T>& ctl, solver_info<T>& info, size_t iter, T rr)
+{
+    if (ctl.keep_history)
+        info.residual_history.push_back(rr);
+    
+    if (ctl.monitor)
+        ctl.monitor(iter, rr);
+}
+
+/* Final message of a solver, "what" is the name of its iterations */
+template<typename T>
+void
+solver_log_result(const solver_control<T>& ctl, const solver_info<T>& info,
+                  const char *what)
+{
+    if (not ctl.log)
+        return;
+    
+    std::ostream& os = *ctl.log;
+    
+    if (info.converged)
+    {
+        os << "Solver converged after " << info.iterations;
+        os << " " << what << ", ||r||/||r0|| = " << info.relative_residual;
+        os << std::endl;
+    }
+    else
+    {
+        os << "Solver NOT converged! ||r||/||r0|| = " << info.relative_residual << std::endl;
+    }
+    
+    if (info.spmv_time > 0)
+    {
+        os << "  Time: SpMV " << info.spmv_time << " s, preconditioner ";
+        os << info.precond_time << " s, vector ops " << info.vector_time << " s";
+        os << std::endl;
+    }
+}
@@ -31,52 +31,48 @@
 #include <armadillo>
 
 #include "element.hpp"
-#include "quadrature.hpp"
 #include "basis.hpp"
+#include "basis_table.hpp"
+#include "moment_table.hpp"
+#include "local_solver.hpp"
 
 
-template<typename T>
+template<typename T, typename Family = scaled_monomials>
 class stabilization_operator
 {
     size_t          m_degree;
     
     arma::Mat<T>    mass_matrix;
     arma::Mat<T>    stab_matrix;
-    basis<T>        m_basis;
-    quadrature<T>   m_quad;
+    basis<T, Family>        m_basis;
+    basis_table<T, Family>  m_table;
+    moment_table<T, Family> m_moments;
     
     void
     build_matrices(const element<T>& elem, const arma::Mat<T>& gradrec_matrix)
     {
-        mass_matrix.resize(m_basis.size(), m_basis.size());
-        mass_matrix.zeros();
-        
-        auto qd = m_quad.integrate(elem);
-        for (auto& qp : qd)
-        {
-            auto qpoint  = qp.first;
-            auto qweight = qp.second;
-            
-            auto phi = m_basis.eval_functions(elem, qpoint);
-            
-            mass_matrix += qweight * phi * phi.t();
-        }
+        mass_matrix = m_moments.mass_matrix(elem);
         
         auto basis_k_size = m_basis.size() - 1;
         auto blocksz = arma::size(basis_k_size, basis_k_size);
         arma::Mat<T> M1 = mass_matrix.submat(0,0,blocksz);
         arma::Mat<T> M2 = mass_matrix.submat(0,1,blocksz);
-        arma::Mat<T> proj1 = -solve(M1, M2*gradrec_matrix);
+        arma::Mat<T> proj1;
+        if (Family::orthogonal)
+        {
+            /* M1 is diagonal, the solve is just a scaling of the rows */
+            proj1 = -M2*gradrec_matrix;
+            for (size_t i = 0; i < basis_k_size; i++)
+                proj1.row(i) /= M1(i,i);
+        }
+        else
+            proj1 = -spd_solver<T>(M1).solve(M2*gradrec_matrix);
         arma::Mat<T> I_T(basis_k_size, basis_k_size);
         I_T.eye();
         proj1.submat(0,0,blocksz) += I_T;
         
-        auto faces = elem.faces();
-        
-        auto phiF1 = m_basis.eval_functions(elem, faces[0]);
-        auto dphiF1 = m_basis.eval_gradients(elem, faces[0]);
-        auto phiF2 = m_basis.eval_functions(elem, faces[1]);
-        auto dphiF2 = m_basis.eval_gradients(elem, faces[1]);
+        auto& phiF1 = m_table.face_functions(0);
+        auto& phiF2 = m_table.face_functions(1);
         
         arma::Mat<T> MFF, proj2, proj3, B;
         arma::Col<T> MFT;
@@ -104,15 +100,17 @@ public:
     stabilization_operator()
         : m_degree(1)
     {
-        m_basis = basis<T>(2);
-        m_quad = quadrature<T>(4);
+        m_basis = basis<T, Family>(2);
+        m_table = basis_table<T, Family>(m_basis);
+        m_moments = moment_table<T, Family>(m_basis.size());
     }
     
     stabilization_operator(size_t degree)
         : m_degree(degree)
     {
-        m_basis = basis<T>( m_degree+1 );
-        m_quad = quadrature<T>( 2*(m_degree+1) );
+        m_basis = basis<T, Family>( m_degree+1 );
+        m_table = basis_table<T, Family>(m_basis);
+        m_moments = moment_table<T, Family>(m_basis.size());
     }
     
     void
@@ -0,0 +1,144 @@
+/*
+ *       /\
+ *      /__\        Matteo Cicuttin (C) 2016 - matteo.cicuttin@enpc.fr
+ *     /_\/_\
+ *    /\    /\      École Nationale des Ponts et Chaussées
+ *   /__\  /__\     CERMICS
+ *  /_\/_\/_\/_\
+ *
+ * This is a simple 1D code for the demonstration of the Hybrid High Order
+ * numerical method. It is intended only to show the details of all the
+ * involved operators (projection, gradient reconstruction, stabilization)
+ * step by step.
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <armadillo>
+#include <cassert>
+
+/* Per-element record of the static condensation. Eliminating the cell
+ * unknowns from K_TT u_T + K_TF u_F = f_T gives u_T = bL - AL u_F, with
+ * AL = K_TT^-1 K_TF and bL = K_TT^-1 f_T. Keeping AL and bL, which the solver
+ * computes anyway, lets postprocess recover the cell unknowns with a small
+ * matrix-vector product instead of rebuilding and solving the local problem.
+ *
+ * The coefficients of the reconstructed potential R [u_T; u_F] are affine in
+ * u_F as well, R_T bL + (R_F - R_T AL) u_F, so they are kept in the same way
+ * and postprocess does not need to rebuild the gradient reconstruction.
+ *
+ * The records of all the elements are stored in a single matrix, one column
+ * per element laid out as [bL; AL.col(0); AL.col(1); rb; RA.col(0); RA.col(1)]
+ * with rb = R_T bL and RA = R_T AL - R_F, so that affine_map computes the
+ * coefficients as rb - RA u_F.
+ */
+template<typename T>
+class condensation_store
+{
+    size_t          m_cell_size;
+    size_t          m_rec_size;
+    arma::Mat<T>    m_data;
+    
+    /* Compute x = b - A u_F, where b is stored at offset and the two columns
+     * of A follow it */
+    arma::Col<T>
+    affine_map(size_t elem_num, size_t offset, size_t size, const arma::Col<T>& solF) const
+    {
+        assert(solF.n_elem == 2);
+        
+        const T *rec = m_data.colptr(elem_num) + offset;
+        arma::Col<T> ret(size);
+        for (size_t i = 0; i < size; i++)
+            ret(i) = rec[i] - rec[size+i]*solF(0) - rec[2*size+i]*solF(1);
+        
+        return ret;
+    }
+    
+public:
+    condensation_store()
+        : m_cell_size(0), m_rec_size(0)
+    {}
+    
+    void
+    resize(size_t num_elements, size_t cell_size, size_t rec_size)
+    {
+        m_cell_size = cell_size;
+        m_rec_size = rec_size;
+        m_data.set_size(3*(cell_size+rec_size), num_elements);
+    }
+    
+    /* R is the gradient reconstruction matrix of the element */
+    void
+    store(size_t elem_num, const arma::Mat<T>& AL, const arma::Col<T>& bL,
+          const arma::Mat<T>& R)
+    {
+        assert(AL.n_rows == m_cell_size and AL.n_cols == 2);
+        assert(bL.n_elem == m_cell_size);
+        assert(R.n_rows == m_rec_size and R.n_cols == m_cell_size+2);
+        
+        store(elem_num, AL.memptr(), bL.memptr(), R.memptr());
+    }
+    
+    /* Same as above, with the matrices given as column-major arrays of the
+     * sizes set by resize(). It does not allocate, so it can be called with
+     * the fixed-size operators. */
+    void
+    store(size_t elem_num, const T *AL, const T *bL, const T *R)
+    {
+        T *rec = m_data.colptr(elem_num);
+        for (size_t i = 0; i < m_cell_size; i++)
+        {
+            rec[i]                  = bL[i];
+            rec[m_cell_size+i]      = AL[i];
+            rec[2*m_cell_size+i]    = AL[m_cell_size+i];
+        }
+        
+        /* rb = R_T bL and RA = R_T AL - R_F, where R_T are the first
+         * m_cell_size columns of R and R_F the last two */
+        rec += 3*m_cell_size;
+        for (size_t i = 0; i < m_rec_size; i++)
+        {
+            T rb = 0., ra0 = 0., ra1 = 0.;
+            for (size_t j = 0; j < m_cell_size; j++)
+            {
+                T r = R[j*m_rec_size+i];
+                rb  += r * bL[j];
+                ra0 += r * AL[j];
+                ra1 += r * AL[m_cell_size+j];
+            }
+            
+            rec[i]                  = rb;
+            rec[m_rec_size+i]       = ra0 - R[m_cell_size*m_rec_size+i];
+            rec[2*m_rec_size+i]     = ra1 - R[(m_cell_size+1)*m_rec_size+i];
+        }
+    }
+    
+    /* Recover the cell unknowns of element elem_num from its face unknowns */
+    arma::Col<T>
+    cell_unknowns(size_t elem_num, const arma::Col<T>& solF) const
+    {
+        return affine_map(elem_num, 0, m_cell_size, solF);
+    }
+    
+    /* Recover the coefficients of the reconstructed potential (without the
+     * constant, which is the first cell unknown) from the face unknowns */
+    arma::Col<T>
+    reconstruction(size_t elem_num, const arma::Col<T>& solF) const
+    {
+        return affine_map(elem_num, 3*m_cell_size, m_rec_size, solF);
+    }
+};
@@ -0,0 +1,69 @@
+/*
+ *       /\
+ *      /__\        Matteo Cicuttin (C) 2016 - matteo.cicuttin@enpc.fr
+ *     /_\/_\
+ *    /\    /\      École Nationale des Ponts et Chaussées
+ *   /__\  /__\     CERMICS
+ *  /_\/_\/_\/_\
+ *
+ * This is a simple 1D code for the demonstration of the Hybrid High Order
+ * numerical method. It is intended only to show the details of all the
+ * involved operators (projection, gradient reconstruction, stabilization)
+ * step by step.
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <armadillo>
+#include <cassert>
+
+/* Thomas algorithm for tridiagonal systems, O(n) time and memory. The matrix
+ * is given by its three diagonals: lower(i) = A(i,i-1) (lower(0) is not used),
+ * diag(i) = A(i,i) and upper(i) = A(i,i+1) (upper(n-1) is not used).
+ * There is no pivoting, so the matrix must be SPD or diagonally dominant, as
+ * the condensed HHO face system with the Dirichlet faces eliminated.
+ */
+template<typename T>
+arma::Col<T>
+tridiagonal_solve(const arma::Col<T>& lower, const arma::Col<T>& diag,
+                  const arma::Col<T>& upper, const arma::Col<T>& b)
+{
+    size_t n = diag.size();
+    assert(lower.size() == n and upper.size() == n and b.size() == n);
+    
+    arma::Col<T> c(n), x(n);
+    
+    if (n == 0)
+        return x;
+    
+    /* Forward elimination: c holds the modified upper diagonal and x the
+     * modified right hand side */
+    c(0) = upper(0)/diag(0);
+    x(0) = b(0)/diag(0);
+    for (size_t i = 1; i < n; i++)
+    {
+        T m = diag(i) - lower(i)*c(i-1);
+        c(i) = upper(i)/m;
+        x(i) = (b(i) - lower(i)*x(i-1))/m;
+    }
+    
+    /* Back substitution */
+    for (size_t i = n-1; i-- > 0; )
+        x(i) -= c(i)*x(i+1);
+    
+    return x;
+}